@@ -0,0 +1,165 @@
+#include "auto_tuner.h"
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <chrono>
+
+/* The block sizes tried for the block inverse and hybrid back-ends (0 is their own choice): */
+static const int candidate_block_sizes[] = {0, 16, 32, 64, 128};
+#define CANDIDATE_BLOCK_SIZES_NO 5
+
+/**
+ * @brief A well conditioned test system (diagonally dominant), so that every back-end converges
+ * and only the time is compared.
+ */
+TriangularSystem generate_tuning_system(int n){
+    TriangularSystem result(n);
+    for(int row_id = 0; row_id < n; row_id++){
+        double * row = result.row(row_id);
+        for(int col_id = row_id + 1; col_id < n; col_id++)row[col_id] = (double)rand() / RAND_MAX;
+        row[row_id] = n + (double)rand() / RAND_MAX;
+        result.free_terms()[row_id] = (double)rand() / RAND_MAX;
+    }
+    return result;
+}
+
+/**
+ * @brief The thread counts tried: the powers of two, then max_threads itself.
+ */
+int next_thread_count(int number_of_threads, int max_threads){
+    if(number_of_threads == max_threads)return max_threads + 1;
+    if(number_of_threads * 2 > max_threads)return max_threads;
+    return number_of_threads * 2;
+}
+
+/**
+ * @brief The best time of TUNING_RUNS solves of rhs_no right hand sides with one configuration.
+ */
+double time_candidate(const TriangularSystem & system, const std::vector<double> & free_terms, int rhs_no, solver_backend backend, int number_of_threads, int block_size){
+    std::unique_ptr<Solver> solver = make_solver(backend, number_of_threads, block_size);
+    double best_seconds = 1e30;
+    for(int run = 0; run < TUNING_RUNS; run++){
+        std::chrono::high_resolution_clock::time_point begin = std::chrono::high_resolution_clock::now();
+        std::vector<double> solution = solver->solve_multiple(system, free_terms, rhs_no);
+        std::chrono::high_resolution_clock::time_point end = std::chrono::high_resolution_clock::now();
+        double seconds = std::chrono::duration_cast<std::chrono::nanoseconds>(end - begin).count() * 1e-9;
+        if(seconds < best_seconds)best_seconds = seconds;
+    }
+    return best_seconds;
+}
+
+/**
+ * @brief Measure every configuration (back-end, number of threads from 1 up to max_threads by
+ * doubling, block size) for every problem size and number of right hand sides, on this machine,
+ * and keep two of each problem: the fastest one (LATENCY_GOAL) and the one with the fewest
+ * seconds x threads (THROUGHPUT_GOAL), for the runs that share the cores between many solves.
+ *
+ * @param sizes The numbers of unknowns to tune for
+ * @param sizes_no The number of sizes
+ * @param rhs_counts The numbers of right hand sides to tune for
+ * @param rhs_counts_no The number of right hand side counts
+ * @param max_threads The largest number of threads tried
+ * @return std::vector<tuning_entry> Two entries per (size, number of right hand sides)
+ */
+std::vector<tuning_entry> run_auto_tuning(const int * sizes, int sizes_no, const int * rhs_counts, int rhs_counts_no, int max_threads){
+    std::vector<tuning_entry> table;
+    /* The compensated back-end is chosen for its accuracy, never for its speed: */
+    solver_backend backends[] = {SEQUENTIAL_BACKEND, OPEN_MP_BACKEND, RECURSIVE_BACKEND, BLOCK_INVERSE_BACKEND, MIXED_PRECISION_BACKEND,
+                                 ROW_PULL_BACKEND, HYBRID_PUSH_BACKEND, HYBRID_PULL_BACKEND, THREADS_BACKEND};
+
+    for(int size_id = 0; size_id < sizes_no; size_id++){
+        int n = sizes[size_id];
+        TriangularSystem system = generate_tuning_system(n);
+
+        for(int rhs_count_id = 0; rhs_count_id < rhs_counts_no; rhs_count_id++){
+            int rhs_no = rhs_counts[rhs_count_id];
+            std::vector<double> free_terms((long long)n * rhs_no);
+            for(size_t i = 0; i < free_terms.size(); i++)free_terms[i] = (double)rand() / RAND_MAX;
+
+            tuning_entry best;
+            best.unknowns_no = n;
+            best.rhs_no = rhs_no;
+            best.seconds = 1e30;
+            best.goal = LATENCY_GOAL;
+            tuning_entry best_throughput = best;
+            best_throughput.goal = THROUGHPUT_GOAL;
+            for(int backend_id = 0; backend_id < 9; backend_id++){
+                solver_backend backend = backends[backend_id];
+                for(int number_of_threads = 1; number_of_threads <= max_threads; number_of_threads = next_thread_count(number_of_threads, max_threads)){
+                    if(backend == SEQUENTIAL_BACKEND && number_of_threads > 1)break;
+                    bool has_block_size = backend == BLOCK_INVERSE_BACKEND || backend == HYBRID_PUSH_BACKEND || backend == HYBRID_PULL_BACKEND;
+                    int block_sizes_no = has_block_size ? CANDIDATE_BLOCK_SIZES_NO : 1;
+                    for(int block_size_id = 0; block_size_id < block_sizes_no; block_size_id++){
+                        int block_size = candidate_block_sizes[block_size_id];
+                        if(block_size > n)continue;
+                        double seconds = time_candidate(system, free_terms, rhs_no, backend, number_of_threads, block_size);
+                        if(seconds < best.seconds){
+                            best.backend = backend;
+                            best.number_of_threads = number_of_threads;
+                            best.block_size = block_size;
+                            best.seconds = seconds;
+                        }
+                        if(seconds * number_of_threads < best_throughput.seconds * best_throughput.number_of_threads){
+                            best_throughput.backend = backend;
+                            best_throughput.number_of_threads = number_of_threads;
+                            best_throughput.block_size = block_size;
+                            best_throughput.seconds = seconds;
+                        }
+                    }
+                }
+            }
+            printf("n = %d, rhs = %d: backend %d, %d threads, block size %d (%.6f s); for throughput, backend %d, %d threads, block size %d (%.6f s)\n",
+                   n, rhs_no, (int)best.backend, best.number_of_threads, best.block_size, best.seconds,
+                   (int)best_throughput.backend, best_throughput.number_of_threads, best_throughput.block_size, best_throughput.seconds);
+            table.push_back(best);
+            table.push_back(best_throughput);
+        }
+    }
+    return table;
+}
+
+/**
+ * @brief Write the table, one entry per line: n, number of right hand sides, back-end,
+ * number of threads, block size, the measured time in seconds and the goal.
+ */
+void write_tuning_table(const std::vector<tuning_entry> & table, const char * filename){
+    FILE * file = fopen(filename, "w");
+    if(file == NULL){
+        printf("Could not write the tuning file %s\n", filename);
+        return;
+    }
+    for(size_t entry_id = 0; entry_id < table.size(); entry_id++){
+        const tuning_entry & entry = table[entry_id];
+        fprintf(file, "%d %d %d %d %d %.9f %d\n", entry.unknowns_no, entry.rhs_no, (int)entry.backend,
+                entry.number_of_threads, entry.block_size, entry.seconds, (int)entry.goal);
+    }
+    fclose(file);
+}
+
+/**
+ * @brief Read a table written by write_tuning_table. A missing file gives an empty table, with
+ * which make_tuned_solver falls back to the sequential back-end. The lines without a goal (the
+ * tables written before THROUGHPUT_GOAL existed) are LATENCY_GOAL entries.
+ */
+std::vector<tuning_entry> read_tuning_table(const char * filename){
+    std::vector<tuning_entry> table;
+    FILE * file = fopen(filename, "r");
+    if(file == NULL)return table;
+    tuning_entry entry;
+    int backend;
+    int goal;
+    char line[256];
+    while(fgets(line, sizeof(line), file)){
+        goal = LATENCY_GOAL;
+        int fields_no = sscanf(line, "%d %d %d %d %d %lf %d", &entry.unknowns_no, &entry.rhs_no, &backend,
+                               &entry.number_of_threads, &entry.block_size, &entry.seconds, &goal);
+        if(fields_no < 6)break;
+        if(backend < SEQUENTIAL_BACKEND || backend > THREADS_BACKEND || entry.number_of_threads < 1 || entry.rhs_no < 1 || entry.unknowns_no < 1)continue;
+        if(goal != LATENCY_GOAL && goal != THROUGHPUT_GOAL)continue;
+        entry.backend = (solver_backend)backend;
+        entry.goal = (tuning_goal)goal;
+        table.push_back(entry);
+    }
+    fclose(file);
+    return table;
+}
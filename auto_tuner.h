@@ -0,0 +1,19 @@
+#include "solver_library.h"
+
+#ifndef AUTO_TUNER_H
+#define AUTO_TUNER_H
+
+#include <vector>
+
+/* The number of timed runs of every candidate; the best one is kept: */
+#define TUNING_RUNS 3
+/* The tuning file written by run_auto_tuner and read by the programs that use make_tuned_solver: */
+#define TUNING_FILENAME "solver_tuning.txt"
+
+std::vector<tuning_entry> run_auto_tuning(const int * sizes, int sizes_no, const int * rhs_counts, int rhs_counts_no, int max_threads);
+
+void write_tuning_table(const std::vector<tuning_entry> & table, const char * filename);
+
+std::vector<tuning_entry> read_tuning_table(const char * filename);
+
+#endif
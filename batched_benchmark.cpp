@@ -0,0 +1,111 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+
+#include <chrono>
+
+#include "linear_system_schema.h"
+#include "batched_solver.h"
+
+#define NUM_THREADS 40
+#define NUMBER_OF_SYSTEMS 100000
+
+/**
+ * @brief Generate a small random upper triangular system, with the same values as generate_system.
+ *
+ * @param n The number of unknowns
+ * @return linear_system_of_equations The generated system
+ */
+linear_system_of_equations generate_small_system(int n){
+    linear_system_of_equations result;
+    result.coefficients = new double*[n];
+    result.free_terms = new double[n];
+    for(int row = 0; row < n; row++){
+        result.coefficients[row] = new double[n];
+        for(int col = 0; col < n; col++){
+            if(col >= row)result.coefficients[row][col] = rand() * 0.1;
+            else result.coefficients[row][col] = 0.0;
+        }
+        if(result.coefficients[row][row] == 0)result.coefficients[row][row] = 1.0;
+        result.free_terms[row] = rand() * 0.1;
+    }
+    result.unknowns_no = n;
+    return result;
+}
+
+/**
+ * @brief The reference: solve every system on its own, with the usual back-substitution.
+ */
+void solve_one_by_one(linear_system_of_equations * systems, int systems_no, double ** solutions){
+    for(int system_id = 0; system_id < systems_no; system_id++){
+        linear_system_of_equations lse = systems[system_id];
+        double * x = solutions[system_id];
+        for(int sol_id = lse.unknowns_no - 1; sol_id > -1; sol_id--){
+            double sum = lse.free_terms[sol_id];
+            for(int j = sol_id + 1; j < lse.unknowns_no; j++)sum -= lse.coefficients[sol_id][j] * x[j];
+            x[sol_id] = sum / lse.coefficients[sol_id][sol_id];
+        }
+    }
+}
+
+void run_benchmark(int n){
+    linear_system_of_equations * systems = new linear_system_of_equations[NUMBER_OF_SYSTEMS];
+    double ** solutions = new double*[NUMBER_OF_SYSTEMS];
+    for(int system_id = 0; system_id < NUMBER_OF_SYSTEMS; system_id++){
+        systems[system_id] = generate_small_system(n);
+        solutions[system_id] = new double[n];
+    }
+
+    batched_linear_systems batch = allocate_batched_systems(n, NUMBER_OF_SYSTEMS);
+    for(int system_id = 0; system_id < NUMBER_OF_SYSTEMS; system_id++)set_batched_system(batch, system_id, systems[system_id]);
+
+    std::chrono::high_resolution_clock::time_point begin = std::chrono::high_resolution_clock::now();
+    solve_one_by_one(systems, NUMBER_OF_SYSTEMS, solutions);
+    std::chrono::high_resolution_clock::time_point end = std::chrono::high_resolution_clock::now();
+    double one_by_one_s = std::chrono::duration_cast<std::chrono::nanoseconds>(end - begin).count() * 1e-9;
+
+    begin = std::chrono::high_resolution_clock::now();
+    batched_system_solver(batch, 1);
+    end = std::chrono::high_resolution_clock::now();
+    double batched_s = std::chrono::duration_cast<std::chrono::nanoseconds>(end - begin).count() * 1e-9;
+
+    begin = std::chrono::high_resolution_clock::now();
+    batched_system_solver(batch, NUM_THREADS);
+    end = std::chrono::high_resolution_clock::now();
+    double batched_parallel_s = std::chrono::duration_cast<std::chrono::nanoseconds>(end - begin).count() * 1e-9;
+
+    /* Check the batched solutions against the reference: */
+    double * solution = new double[n];
+    double max_difference = 0.0;
+    for(int system_id = 0; system_id < NUMBER_OF_SYSTEMS; system_id++){
+        get_batched_solution(batch, system_id, solution);
+        for(int i = 0; i < n; i++){
+            double difference = fabs(solution[i] - solutions[system_id][i]) / (fabs(solutions[system_id][i]) + 1e-300);
+            if(difference > max_difference)max_difference = difference;
+        }
+    }
+
+    printf("n = %d, systems = %d\n", n, NUMBER_OF_SYSTEMS);
+    printf("one_by_one: %f systems/s\n", NUMBER_OF_SYSTEMS / one_by_one_s);
+    printf("batched, 1 thread: %f systems/s\n", NUMBER_OF_SYSTEMS / batched_s);
+    printf("batched, %d threads: %f systems/s\n", NUM_THREADS, NUMBER_OF_SYSTEMS / batched_parallel_s);
+    printf("max relative difference = %e\n", max_difference);
+
+    for(int system_id = 0; system_id < NUMBER_OF_SYSTEMS; system_id++){
+        for(int row = 0; row < n; row++)delete[] systems[system_id].coefficients[row];
+        delete[] systems[system_id].coefficients;
+        delete[] systems[system_id].free_terms;
+        delete[] solutions[system_id];
+    }
+    delete[] systems;
+    delete[] solutions;
+    delete[] solution;
+    free_batched_systems(batch);
+}
+
+int main(){
+    srand(0);
+    int sizes[] = {4, 8, 16, 32, 64};
+    for(int size_id = 0; size_id < 5; size_id++)run_benchmark(sizes[size_id]);
+    return 0;
+}
@@ -0,0 +1,157 @@
+#include "batched_solver.h"
+
+/**
+ * @brief The position of the coefficient (row_id, col_id), col_id >= row_id, inside a packed
+ * upper triangle of n x n, stored row by row.
+ */
+inline int packed_index(int row_id, int col_id, int n){
+    return row_id * n - row_id * (row_id - 1) / 2 + (col_id - row_id);
+}
+
+/**
+ * @brief Allocate a batch of systems_no systems with unknowns_no unknowns each. Every system
+ * starts as the identity with null free terms, so the unused lanes of the last group are
+ * always solvable.
+ *
+ * @param unknowns_no The number of unknowns of every system in the batch
+ * @param systems_no The number of systems in the batch
+ * @return batched_linear_systems The allocated batch
+ */
+batched_linear_systems allocate_batched_systems(int unknowns_no, int systems_no){
+    batched_linear_systems batch;
+    batch.unknowns_no = unknowns_no;
+    batch.systems_no = systems_no;
+    batch.groups_no = (systems_no + BATCH_LANES - 1) / BATCH_LANES;
+
+    long long packed_size = (long long)unknowns_no * (unknowns_no + 1) / 2;
+    long long vector_size = (long long)batch.groups_no * unknowns_no * BATCH_LANES;
+    batch.coefficients = new double[batch.groups_no * packed_size * BATCH_LANES];
+    batch.free_terms = new double[vector_size];
+    batch.solutions = new double[vector_size];
+
+    for(int group_id = 0; group_id < batch.groups_no; group_id++){
+        double * group = batch.coefficients + group_id * packed_size * BATCH_LANES;
+        for(int row_id = 0; row_id < unknowns_no; row_id++){
+            for(int col_id = row_id; col_id < unknowns_no; col_id++){
+                for(int lane = 0; lane < BATCH_LANES; lane++){
+                    group[packed_index(row_id, col_id, unknowns_no) * BATCH_LANES + lane] = (row_id == col_id) ? 1.0 : 0.0;
+                }
+            }
+        }
+    }
+    for(long long i = 0; i < vector_size; i++){
+        batch.free_terms[i] = 0.0;
+        batch.solutions[i] = 0.0;
+    }
+    return batch;
+}
+
+void free_batched_systems(batched_linear_systems batch){
+    delete[] batch.coefficients;
+    delete[] batch.free_terms;
+    delete[] batch.solutions;
+}
+
+/**
+ * @brief Copy one system into its lane of the batch.
+ *
+ * @param batch The batch
+ * @param system_index The index of the system inside the batch
+ * @param lse The system; it must have batch.unknowns_no unknowns
+ */
+void set_batched_system(batched_linear_systems batch, int system_index, linear_system_of_equations lse){
+    int n = batch.unknowns_no;
+    int group_id = system_index / BATCH_LANES;
+    int lane = system_index % BATCH_LANES;
+    long long packed_size = (long long)n * (n + 1) / 2;
+    double * group = batch.coefficients + group_id * packed_size * BATCH_LANES;
+    double * free_terms = batch.free_terms + (long long)group_id * n * BATCH_LANES;
+    for(int row_id = 0; row_id < n; row_id++){
+        for(int col_id = row_id; col_id < n; col_id++){
+            group[packed_index(row_id, col_id, n) * BATCH_LANES + lane] = lse.coefficients[row_id][col_id];
+        }
+        free_terms[row_id * BATCH_LANES + lane] = lse.free_terms[row_id];
+    }
+}
+
+/**
+ * @brief Copy the solution of one system out of the batch.
+ *
+ * @param batch The (solved) batch
+ * @param system_index The index of the system inside the batch
+ * @param solution Output: an array of batch.unknowns_no values
+ */
+void get_batched_solution(batched_linear_systems batch, int system_index, double * solution){
+    int n = batch.unknowns_no;
+    int group_id = system_index / BATCH_LANES;
+    int lane = system_index % BATCH_LANES;
+    double * solutions = batch.solutions + (long long)group_id * n * BATCH_LANES;
+    for(int row_id = 0; row_id < n; row_id++)solution[row_id] = solutions[row_id * BATCH_LANES + lane];
+}
+
+/**
+ * @brief Back-substitution for all the lanes of a group. With N known at compile time,
+ * the loops over the columns are fully unrolled and the loops over the lanes become
+ * SIMD instructions; N = 0 is the kernel for the sizes that do not have an unrolled version,
+ * which takes the size at run time. A lane with a null diagonal coefficient gets a null unknown.
+ */
+template<int N>
+void solve_group(const double * coefficients, const double * free_terms, double * x, int n){
+    const int width = (N > 0) ? N : n;
+    for(int row_id = width - 1; row_id > -1; row_id--){
+        const double * row = coefficients + packed_index(row_id, row_id, width) * BATCH_LANES;
+        double sum[BATCH_LANES];
+        #pragma omp simd
+        for(int lane = 0; lane < BATCH_LANES; lane++)sum[lane] = free_terms[row_id * BATCH_LANES + lane];
+        for(int col_id = row_id + 1; col_id < width; col_id++){
+            #pragma omp simd
+            for(int lane = 0; lane < BATCH_LANES; lane++)
+                sum[lane] -= row[(col_id - row_id) * BATCH_LANES + lane] * x[col_id * BATCH_LANES + lane];
+        }
+        #pragma omp simd
+        for(int lane = 0; lane < BATCH_LANES; lane++)
+            x[row_id * BATCH_LANES + lane] = (row[lane] != 0) ? sum[lane] / row[lane] : 0;
+    }
+}
+
+typedef void (*group_kernel)(const double *, const double *, double *, int);
+
+/* Fill kernel_table[1..N] with the unrolled kernels, and kernel_table[0] with the run-time one: */
+template<int N>
+struct kernel_table_filler {
+    static void fill(group_kernel * kernel_table){
+        kernel_table[N] = &solve_group<N>;
+        kernel_table_filler<N - 1>::fill(kernel_table);
+    }
+};
+
+template<>
+struct kernel_table_filler<0> {
+    static void fill(group_kernel * kernel_table){
+        kernel_table[0] = &solve_group<0>;
+    }
+};
+
+/**
+ * @brief Solve all the systems of the batch; the solutions are stored in batch.solutions
+ * and can be read with get_batched_solution. The groups are split between the threads.
+ *
+ * @param batch The batch of systems
+ * @param number_of_threads The number of OpenMP threads
+ */
+void batched_system_solver(batched_linear_systems batch, int number_of_threads){
+    group_kernel kernel_table[MAX_UNROLLED_UNKNOWNS + 1];
+    kernel_table_filler<MAX_UNROLLED_UNKNOWNS>::fill(kernel_table);
+
+    int n = batch.unknowns_no;
+    group_kernel kernel = (n <= MAX_UNROLLED_UNKNOWNS) ? kernel_table[n] : kernel_table[0];
+    long long packed_size = (long long)n * (n + 1) / 2;
+
+    #pragma omp parallel for schedule(static) num_threads(number_of_threads)
+    for(int group_id = 0; group_id < batch.groups_no; group_id++){
+        const double * coefficients = batch.coefficients + group_id * packed_size * BATCH_LANES;
+        const double * free_terms = batch.free_terms + (long long)group_id * n * BATCH_LANES;
+        double * solutions = batch.solutions + (long long)group_id * n * BATCH_LANES;
+        kernel(coefficients, free_terms, solutions, n);
+    }
+}
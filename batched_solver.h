@@ -0,0 +1,37 @@
+#include "linear_system_schema.h"
+
+#ifndef BATCHED_SOLVER_H
+#define BATCHED_SOLVER_H
+
+/* The number of systems interleaved in one group (one system per SIMD lane): */
+#define BATCH_LANES 8
+/* The largest system size that has a compile-time unrolled kernel: */
+#define MAX_UNROLLED_UNKNOWNS 64
+
+/**
+ * @brief Many small upper triangular systems of the same size, stored as a structure of arrays.
+ * The systems are split in groups of BATCH_LANES; inside a group, the same coefficient of all
+ * the systems is stored contiguously, so a kernel solves all the lanes of a group at once.
+ * The coefficients of a group are the packed upper triangle, row by row:
+ * coefficients[((group * packed_size) + packed_index(row, col)) * BATCH_LANES + lane]
+ */
+struct batched_linear_systems {
+    double *coefficients;
+    double *free_terms;
+    double *solutions;
+    int unknowns_no;
+    int systems_no;
+    int groups_no;
+};
+
+batched_linear_systems allocate_batched_systems(int unknowns_no, int systems_no);
+
+void free_batched_systems(batched_linear_systems batch);
+
+void set_batched_system(batched_linear_systems batch, int system_index, linear_system_of_equations lse);
+
+void get_batched_solution(batched_linear_systems batch, int system_index, double * solution);
+
+void batched_system_solver(batched_linear_systems batch, int number_of_threads);
+
+#endif
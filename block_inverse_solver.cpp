@@ -0,0 +1,117 @@
+#include "block_inverse_solver.h"
+#include <math.h>
+
+/**
+ * @brief Choose the size of the diagonal blocks. Inverting the blocks costs about
+ * n * block_size^2 / 3 extra operations, while the critical path of the solve is n / block_size
+ * steps; block_size ~ sqrt(n) keeps the extra work below the n^2 / 2 of the back-substitution
+ * and shortens the critical path by the same factor.
+ *
+ * @param unknowns_no The number of unknowns
+ * @return int The block size: a multiple of 8 between MIN_INVERSE_BLOCK_SIZE and MAX_INVERSE_BLOCK_SIZE
+ */
+int choose_inverse_block_size(int unknowns_no){
+    int block_size = ((int)sqrt((double)unknowns_no) + 7) / 8 * 8;
+    if(block_size < MIN_INVERSE_BLOCK_SIZE)block_size = MIN_INVERSE_BLOCK_SIZE;
+    if(block_size > MAX_INVERSE_BLOCK_SIZE)block_size = MAX_INVERSE_BLOCK_SIZE;
+    return block_size;
+}
+
+/**
+ * @brief Invert one upper triangular diagonal block, one column at a time. The inverse is
+ * also upper triangular; a null pivot gives a null row, as in the other solvers.
+ *
+ * @param coefficients The coefficient matrix
+ * @param first_row The first row of the block
+ * @param size The number of rows of the block
+ * @param inverse Output: size x size values, row by row
+ */
+void invert_diagonal_block(double ** coefficients, int first_row, int size, double * inverse){
+    for(int i = 0; i < size * size; i++)inverse[i] = 0.0;
+    for(int col_id = 0; col_id < size; col_id++){
+        /* Solve U * inverse[:, col_id] = e_col_id: */
+        for(int row_id = col_id; row_id > -1; row_id--){
+            double * row = coefficients[first_row + row_id] + first_row;
+            double sum = (row_id == col_id) ? 1.0 : 0.0;
+            for(int k = row_id + 1; k <= col_id; k++)sum -= row[k] * inverse[k * size + col_id];
+            if(row[row_id] != 0)inverse[row_id * size + col_id] = sum / row[row_id];
+            else inverse[row_id * size + col_id] = 0.0;
+        }
+    }
+}
+
+/**
+ * @brief Invert all the diagonal blocks of the system, in parallel.
+ *
+ * @param lse The linear system of equations
+ * @param block_size The size of the diagonal blocks; 0 chooses it with choose_inverse_block_size
+ * @param number_of_threads The number of OpenMP threads
+ * @return block_inverse_system The system with the cached inverses
+ */
+block_inverse_system prepare_block_inverse_system(linear_system_of_equations lse, int block_size, int number_of_threads){
+    block_inverse_system result;
+    result.lse = lse;
+    result.block_size = (block_size > 0) ? block_size : choose_inverse_block_size(lse.unknowns_no);
+    result.blocks_no = (lse.unknowns_no + result.block_size - 1) / result.block_size;
+    result.inverse_blocks = new double*[result.blocks_no];
+
+    #pragma omp parallel for schedule(dynamic, 1) num_threads(number_of_threads)
+    for(int block_id = 0; block_id < result.blocks_no; block_id++){
+        int first_row = block_id * result.block_size;
+        int size = (lse.unknowns_no - first_row < result.block_size) ? lse.unknowns_no - first_row : result.block_size;
+        result.inverse_blocks[block_id] = new double[size * size];
+        invert_diagonal_block(lse.coefficients, first_row, size, result.inverse_blocks[block_id]);
+    }
+    return result;
+}
+
+/**
+ * @brief Solve the system with the cached block inverses. Every step of the critical path solves
+ * a whole block with a dense matrix-vector product, then subtracts its contribution from the
+ * partial sums of all the rows above it; both products are split between the threads.
+ *
+ * @param bis The system with its block inverses
+ * @param number_of_threads The number of OpenMP threads
+ * @return double* The solution of the system
+ */
+double * block_inverse_solver(block_inverse_system * bis, int number_of_threads){
+    int n = bis->lse.unknowns_no;
+    double ** coefficients = bis->lse.coefficients;
+    double * solution = new double[n];
+    double * sum = new double[n];
+    for(int row_id = 0; row_id < n; row_id++)sum[row_id] = bis->lse.free_terms[row_id];
+
+    #pragma omp parallel default(none) shared(bis, coefficients, solution, sum, n) num_threads(number_of_threads)
+    {
+        for(int block_id = bis->blocks_no - 1; block_id > -1; block_id--){
+            int first_row = block_id * bis->block_size;
+            int size = (n - first_row < bis->block_size) ? n - first_row : bis->block_size;
+            double * inverse = bis->inverse_blocks[block_id];
+
+            /* x_block = inverse_block * sum_block: */
+            #pragma omp for schedule(static)
+            for(int i = 0; i < size; i++){
+                double value = 0.0;
+                for(int k = i; k < size; k++)value += inverse[i * size + k] * sum[first_row + k];
+                solution[first_row + i] = value;
+            }
+
+            /* sum[0 .. first_row) -= U[0 .. first_row, block] * x_block: */
+            #pragma omp for schedule(static)
+            for(int row_id = 0; row_id < first_row; row_id++){
+                double * row = coefficients[row_id] + first_row;
+                double value = 0.0;
+                for(int k = 0; k < size; k++)value += row[k] * solution[first_row + k];
+                sum[row_id] -= value;
+            }
+        }
+    }
+
+    delete[] sum;
+    return solution;
+}
+
+void free_block_inverse_system(block_inverse_system bis){
+    for(int block_id = 0; block_id < bis.blocks_no; block_id++)delete[] bis.inverse_blocks[block_id];
+    delete[] bis.inverse_blocks;
+}
@@ -0,0 +1,30 @@
+#include "linear_system_schema.h"
+
+#ifndef BLOCK_INVERSE_SOLVER_H
+#define BLOCK_INVERSE_SOLVER_H
+
+#define MIN_INVERSE_BLOCK_SIZE 8
+#define MAX_INVERSE_BLOCK_SIZE 256
+
+/**
+ * @brief A system together with the inverses of its diagonal blocks. The inverses are computed
+ * once by prepare_block_inverse_system and reused by every solve.
+ * Block b covers the rows [b * block_size, min(n, (b + 1) * block_size)); its inverse is stored
+ * row by row in inverse_blocks[b].
+ */
+struct block_inverse_system {
+    linear_system_of_equations lse;
+    double **inverse_blocks;
+    int block_size;
+    int blocks_no;
+};
+
+int choose_inverse_block_size(int unknowns_no);
+
+block_inverse_system prepare_block_inverse_system(linear_system_of_equations lse, int block_size, int number_of_threads);
+
+double * block_inverse_solver(block_inverse_system * bis, int number_of_threads);
+
+void free_block_inverse_system(block_inverse_system bis);
+
+#endif
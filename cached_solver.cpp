@@ -0,0 +1,44 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <chrono>
+
+#include "shared_matrix_cache.h"
+#include "open_mp_solver.h"
+
+#define NUM_THREADS 40
+
+double elapsed_ms(std::chrono::high_resolution_clock::time_point begin){
+    std::chrono::high_resolution_clock::time_point end = std::chrono::high_resolution_clock::now();
+    return std::chrono::duration_cast<std::chrono::microseconds>(end - begin).count() / 1000.0;
+}
+
+/**
+ * @brief Solve a system taken from the host-wide cache: the first run parses the files, the
+ * following ones (from any process) attach the parsed system. Usage:
+ * cached_solver [coeff_file free_terms_file unknowns_no] | cached_solver clear
+ */
+int main(int argc, char ** argv){
+    if(argc > 1 && strcmp(argv[1], "clear") == 0){
+        clear_shared_matrix_cache();
+        printf("cache cleared\n");
+        return 0;
+    }
+    char * matrix_coeff_filename = (argc > 3) ? argv[1] : (char *)"a_input_1000.txt";
+    char * free_terms_filename = (argc > 3) ? argv[2] : (char *)"free_terms_1000.txt";
+    int number_of_unknowns = (argc > 3) ? atoi(argv[3]) : 1000;
+
+    std::chrono::high_resolution_clock::time_point begin = std::chrono::high_resolution_clock::now();
+    shared_matrix_handle handle = attach_shared_matrix(matrix_coeff_filename, free_terms_filename, number_of_unknowns, SHARED_CACHE_MEMORY_BUDGET);
+    double attach_ms = elapsed_ms(begin);
+    printf("system %s in %.3f ms\n", handle.entry_id < 0 ? "read privately" : "taken from the cache", attach_ms);
+
+    begin = std::chrono::high_resolution_clock::now();
+    double * solution = open_mp_parallel_solver(handle.system, NUM_THREADS);
+    printf("solved in %.3f ms; x[0] = %e, x[n - 1] = %e\n", elapsed_ms(begin), solution[0], solution[number_of_unknowns - 1]);
+
+    delete[] solution;
+    detach_shared_matrix(handle);
+    return 0;
+}
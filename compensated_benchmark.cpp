@@ -0,0 +1,145 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+
+#include <chrono>
+
+#include "linear_system_schema.h"
+#include "system_reader.h"
+#include "triangular_solver.h"
+#include "compensated_solver.h"
+
+#define NUM_THREADS 40
+/* Every timing is the best of this many runs: */
+#define BENCHMARK_RUNS 5
+
+/**
+ * @brief A random upper triangular system with off-diagonal values in [-1, 1] and a diagonal in
+ * [1, 2]: such matrices get exponentially ill-conditioned with n.
+ */
+linear_system_of_equations generate_ill_conditioned_system(int n){
+    linear_system_of_equations result;
+    result.coefficients = new double*[n];
+    result.free_terms = new double[n];
+    for(int row = 0; row < n; row++){
+        result.coefficients[row] = new double[n];
+        for(int col = 0; col < n; col++){
+            if(col > row)result.coefficients[row][col] = 2.0 * rand() / RAND_MAX - 1.0;
+            else result.coefficients[row][col] = 0.0;
+        }
+        result.coefficients[row][row] = 1.0 + (double)rand() / RAND_MAX;
+        result.free_terms[row] = 2.0 * rand() / RAND_MAX - 1.0;
+    }
+    result.unknowns_no = n;
+    return result;
+}
+
+void free_system(linear_system_of_equations lse){
+    for(int row = 0; row < lse.unknowns_no; row++)delete[] lse.coefficients[row];
+    delete[] lse.coefficients;
+    delete[] lse.free_terms;
+}
+
+/**
+ * @brief The back-substitution in a wider type: long double for the usual accurate mode,
+ * __float128 (113 bits, emulated) for the reference.
+ */
+template<typename REAL>
+double * wide_back_substitution(linear_system_of_equations lse){
+    int n = lse.unknowns_no;
+    REAL * wide = new REAL[n];
+    for(int sol_id = n - 1; sol_id > -1; sol_id--){
+        double * row = lse.coefficients[sol_id];
+        REAL sum = lse.free_terms[sol_id];
+        for(int j = sol_id + 1; j < n; j++)sum -= (REAL)row[j] * wide[j];
+        wide[sol_id] = sum / (REAL)row[sol_id];
+    }
+    double * result = new double[n];
+    for(int i = 0; i < n; i++)result[i] = (double)wide[i];
+    delete[] wide;
+    return result;
+}
+
+double * plain_sequential(linear_system_of_equations lse){
+    return triangular_system_solver(lse, UPPER_TRIANGLE, NO_TRANSPOSE, NON_UNIT_DIAGONAL, 1);
+}
+double * plain_parallel(linear_system_of_equations lse){
+    return triangular_system_solver(lse, UPPER_TRIANGLE, NO_TRANSPOSE, NON_UNIT_DIAGONAL, NUM_THREADS);
+}
+double * compensated_sequential(linear_system_of_equations lse){
+    return compensated_system_solver(lse, 1);
+}
+double * compensated_parallel(linear_system_of_equations lse){
+    return compensated_system_solver(lse, NUM_THREADS);
+}
+
+/**
+ * @brief The normwise relative error: max |x - reference| / max |reference|.
+ */
+double relative_error(double * solution, double * reference, int n){
+    double error = 0.0;
+    double norm = 0.0;
+    for(int i = 0; i < n; i++){
+        if(fabs(solution[i] - reference[i]) > error)error = fabs(solution[i] - reference[i]);
+        if(fabs(reference[i]) > norm)norm = fabs(reference[i]);
+    }
+    return error / norm;
+}
+
+/**
+ * @brief Time a solver (best of BENCHMARK_RUNS) and compare its solution with the reference.
+ *
+ * @return double The best time, in ms
+ */
+double measure(const char * name, double * (*solver)(linear_system_of_equations), linear_system_of_equations lse, double * reference, double baseline_ms){
+    double best_ms = 1e30;
+    double error = 0.0;
+    for(int run = 0; run < BENCHMARK_RUNS; run++){
+        std::chrono::high_resolution_clock::time_point begin = std::chrono::high_resolution_clock::now();
+        double * solution = solver(lse);
+        std::chrono::high_resolution_clock::time_point end = std::chrono::high_resolution_clock::now();
+        double ms = std::chrono::duration_cast<std::chrono::nanoseconds>(end - begin).count() * 1e-6;
+        if(ms < best_ms)best_ms = ms;
+        error = relative_error(solution, reference, lse.unknowns_no);
+        delete[] solution;
+    }
+    if(baseline_ms > 0)printf("%-24s %10.3f ms  (%5.2fx)   relative error = %e\n", name, best_ms, best_ms / baseline_ms, error);
+    else printf("%-24s %10.3f ms  (1.00x)   relative error = %e\n", name, best_ms, error);
+    return best_ms;
+}
+
+void run_benchmark(const char * system_name, linear_system_of_equations lse){
+    printf("\n=== %s, n = %d ===\n", system_name, lse.unknowns_no);
+    double * reference = wide_back_substitution<__float128>(lse);
+
+    double sequential_ms = measure("double", &plain_sequential, lse, reference, 0.0);
+    measure("compensated", &compensated_sequential, lse, reference, sequential_ms);
+    measure("long double", &wide_back_substitution<long double>, lse, reference, sequential_ms);
+    double parallel_ms = measure("double, parallel", &plain_parallel, lse, reference, 0.0);
+    measure("compensated, parallel", &compensated_parallel, lse, reference, parallel_ms);
+    delete[] reference;
+}
+
+/**
+ * @brief Compare the plain double kernel with the compensated one (and with long double) for the
+ * time and the error against a __float128 reference.
+ */
+int main(){
+#ifdef FP_FAST_FMA
+    printf("TwoProd: hardware FMA\n");
+#else
+    printf("TwoProd: Veltkamp split (build with -mfma for the FMA version)\n");
+#endif
+    srand(1);
+    linear_system_of_equations lse = read_linear_system("a_input_1000.txt", "free_terms_1000.txt", 1000);
+    run_benchmark("a_input_1000", lse);
+    free_system(lse);
+
+    int sizes[] = {200, 1000, 4000};
+    for(int size_id = 0; size_id < 3; size_id++){
+        lse = generate_ill_conditioned_system(sizes[size_id]);
+        run_benchmark("random ill-conditioned", lse);
+        free_system(lse);
+    }
+    return 0;
+}
@@ -0,0 +1,138 @@
+#include "compensated_solver.h"
+#include "triangular_solver.h"
+
+/**
+ * @brief Dot2 (Ogita, Rump and Oishi) of ROWS rows at once: sums[r] + compensations[r] is
+ * rows[r][begin..end) . x[begin..end) as if computed in twice the working precision, returned
+ * unevaluated. dx holds small corrections of x, whose (plain) dot product with the row is added to
+ * the compensation. The rows share the loads of x and dx (and, without FMA, the split of x), and
+ * each of them is read once, contiguously; COMPENSATED_LANES partial sums per row run side by
+ * side so that the loop vectorizes, and are merged with TwoSum at the end.
+ */
+template<int ROWS>
+void compensated_dot_rows(double * const * rows, const double * x, const double * dx, int begin, int end, double * sums, double * compensations){
+    double lane_sums[ROWS][COMPENSATED_LANES];
+    double lane_errors[ROWS][COMPENSATED_LANES];
+    for(int r = 0; r < ROWS; r++){
+        for(int lane = 0; lane < COMPENSATED_LANES; lane++){
+            lane_sums[r][lane] = 0.0;
+            lane_errors[r][lane] = 0.0;
+        }
+    }
+
+    int j = begin;
+    for(; j + COMPENSATED_LANES <= end; j += COMPENSATED_LANES){
+        for(int r = 0; r < ROWS; r++){
+            const double * a = rows[r] + j;
+            #pragma omp simd
+            for(int lane = 0; lane < COMPENSATED_LANES; lane++){
+                double product, product_error, partial, sum_error;
+                two_prod(a[lane], x[j + lane], product, product_error);
+                two_sum(lane_sums[r][lane], product, partial, sum_error);
+                lane_sums[r][lane] = partial;
+                lane_errors[r][lane] += (product_error + sum_error) + a[lane] * dx[j + lane];
+            }
+        }
+    }
+    for(int lane = 0; j < end; j++, lane++){
+        for(int r = 0; r < ROWS; r++){
+            double product, product_error, partial, sum_error;
+            two_prod(rows[r][j], x[j], product, product_error);
+            two_sum(lane_sums[r][lane], product, partial, sum_error);
+            lane_sums[r][lane] = partial;
+            lane_errors[r][lane] += (product_error + sum_error) + rows[r][j] * dx[j];
+        }
+    }
+
+    /* Merge the lanes pairwise, so the dependency chain is log2(COMPENSATED_LANES) TwoSums long: */
+    for(int r = 0; r < ROWS; r++){
+        for(int width = COMPENSATED_LANES / 2; width > 0; width /= 2){
+            for(int lane = 0; lane < width; lane++){
+                double partial, sum_error;
+                two_sum(lane_sums[r][lane], lane_sums[r][lane + width], partial, sum_error);
+                lane_sums[r][lane] = partial;
+                lane_errors[r][lane] += lane_errors[r][lane + width] + sum_error;
+            }
+        }
+        sums[r] = lane_sums[r][0];
+        compensations[r] = lane_errors[r][0];
+    }
+}
+
+/**
+ * @brief Dot2 of a single row: sum + compensation is a[begin..end) . x[begin..end).
+ */
+void compensated_dot(const double * a, const double * x, const double * dx, int begin, int end, double & sum, double & compensation){
+    double * row = (double *)a;
+    compensated_dot_rows<1>(&row, x, dx, begin, end, &sum, &compensation);
+}
+
+/**
+ * @brief The compensated triangular solve (CompTRSV, Langlois and Louvet), blocked in the pull
+ * form. Each unknown is computed in double together with an approximation dx of its error: the
+ * residuals of the equations are kept as a double plus its rounding error (the dot products are
+ * Dot2 and their subtraction from the free terms is a TwoSum), the rounding error of the division
+ * is recovered exactly, and dx solves the same system with those errors as free terms. The
+ * solution is x + dx, which is about as accurate as a solve in twice the precision rounded to
+ * double.
+ * Before a block of TRIANGULAR_BLOCK_SIZE unknowns is solved, its rows take their dot products
+ * with all the unknowns already solved, COMPENSATED_ROWS rows per pass (shared by the threads);
+ * so every row is read once, in one long contiguous pass, and the lanes are merged once per row
+ * instead of once per block. One thread then solves the diagonal block.
+ *
+ * @param lse The linear system of equations; only the upper triangle is read
+ * @param number_of_threads The number of OpenMP threads used by the row passes
+ * @return double* The solution of the system
+ */
+double * compensated_system_solver(linear_system_of_equations lse, int number_of_threads){
+    int n = lse.unknowns_no;
+    double ** a = lse.coefficients;
+    double * x = new double[n];
+    double * dx = new double[n];
+    double * sums = new double[n];
+    double * compensations = new double[n];
+    for(int i = 0; i < n; i++){
+        x[i] = 0.0;
+        dx[i] = 0.0;
+    }
+
+    int blocks_no = (n + TRIANGULAR_BLOCK_SIZE - 1) / TRIANGULAR_BLOCK_SIZE;
+    for(int block_id = blocks_no - 1; block_id >= 0; block_id--){
+        int first = block_id * TRIANGULAR_BLOCK_SIZE;
+        int last = (first + TRIANGULAR_BLOCK_SIZE < n) ? first + TRIANGULAR_BLOCK_SIZE : n;
+
+        /* The rows of the block against the unknowns already solved: */
+        int groups_no = (last - first + COMPENSATED_ROWS - 1) / COMPENSATED_ROWS;
+        #pragma omp parallel for schedule(static) num_threads(number_of_threads) if(n - last > TRIANGULAR_PARALLEL_THRESHOLD)
+        for(int group = 0; group < groups_no; group++){
+            int i = first + group * COMPENSATED_ROWS;
+            if(i + COMPENSATED_ROWS <= last)compensated_dot_rows<COMPENSATED_ROWS>(a + i, x, dx, last, n, sums + i, compensations + i);
+            else for(; i < last; i++)compensated_dot_rows<1>(a + i, x, dx, last, n, sums + i, compensations + i);
+        }
+
+        /* The diagonal block: */
+        for(int i = last - 1; i >= first; i--){
+            double block_sum, block_compensation, sum, sum_error, residual, error;
+            compensated_dot_rows<1>(a + i, x, dx, i + 1, last, &block_sum, &block_compensation);
+            two_sum(sums[i], block_sum, sum, sum_error);
+            two_sum(lse.free_terms[i], -sum, residual, error);
+            double residual_error = error - (compensations[i] + block_compensation + sum_error);
+            if(a[i][i] != 0){
+                double product, product_error;
+                x[i] = residual / a[i][i];
+                two_prod(x[i], a[i][i], product, product_error);
+                dx[i] = ((residual - product) - product_error + residual_error) / a[i][i];
+            }
+            else{
+                x[i] = 0;
+                dx[i] = 0;
+            }
+        }
+    }
+
+    for(int i = 0; i < n; i++)x[i] += dx[i];
+    delete[] dx;
+    delete[] sums;
+    delete[] compensations;
+    return x;
+}
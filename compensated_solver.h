@@ -0,0 +1,60 @@
+#include "linear_system_schema.h"
+
+#ifndef COMPENSATED_SOLVER_H
+#define COMPENSATED_SOLVER_H
+
+#include <math.h>
+
+/* The number of independent partial sums of a compensated dot product (one SIMD register or two): */
+#define COMPENSATED_LANES 8
+/* The number of rows whose compensated dot products share one pass over x: */
+#define COMPENSATED_ROWS 4
+
+/*
+ * The error-free transformations below rely on every operation being rounded on its own:
+ * compile without -ffast-math and with -ffp-contract=off (the default of the -std=c++ modes,
+ * but not of -std=gnu++). With -mfma (or -march=native on a machine with FMA), FP_FAST_FMA is
+ * defined and the product error costs a single instruction; otherwise it uses Veltkamp's split.
+ */
+
+/**
+ * @brief TwoSum: sum + error == a + b exactly.
+ */
+inline void two_sum(double a, double b, double & sum, double & error){
+    sum = a + b;
+    double b_virtual = sum - a;
+    error = (a - (sum - b_virtual)) + (b - b_virtual);
+}
+
+/**
+ * @brief TwoProd: product + error == a * b exactly (barring underflow).
+ */
+inline void two_prod(double a, double b, double & product, double & error){
+    product = a * b;
+#ifdef FP_FAST_FMA
+    error = fma(a, b, -product);
+#else
+    const double splitter = 134217729.0; /* 2^27 + 1 */
+    double a_big = splitter * a;
+    double a_high = a_big - (a_big - a);
+    double a_low = a - a_high;
+    double b_big = splitter * b;
+    double b_high = b_big - (b_big - b);
+    double b_low = b - b_high;
+    error = ((a_high * b_high - product) + a_high * b_low + a_low * b_high) + a_low * b_low;
+#endif
+}
+
+/*
+ * The cost of the compensated solve depends on the product error (best of 5, one thread,
+ * n >= 1000, against the plain double solve): with the hardware FMA it is one instruction per
+ * coefficient and the solve costs 0.8x to 1.4x; with Veltkamp's split it takes about 17 flops
+ * per coefficient, and the solve costs 2.5x to 4x at n = 1000 (1.3x to 1.9x at n = 4000, where
+ * the matrix no longer fits in the caches).
+ */
+
+void compensated_dot(const double * a, const double * x, const double * dx, int begin, int end, double & sum, double & compensation);
+
+double * compensated_system_solver(linear_system_of_equations lse, int number_of_threads);
+
+#endif
@@ -0,0 +1,70 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/stat.h>
+
+#include <chrono>
+
+#include "system_reader.h"
+#include "compressed_container.h"
+
+#define NUM_THREADS 40
+
+double elapsed_ms(std::chrono::high_resolution_clock::time_point begin){
+    std::chrono::high_resolution_clock::time_point end = std::chrono::high_resolution_clock::now();
+    return std::chrono::duration_cast<std::chrono::microseconds>(end - begin).count() / 1000.0;
+}
+
+long long file_size(char * filename){
+    struct stat file_stat;
+    if(stat(filename, &file_stat) != 0)return 0;
+    return file_stat.st_size;
+}
+
+/**
+ * @brief Convert a text system to a container, then compare the sizes and the load times of both.
+ * Usage: compress_system coeff_file free_terms_file unknowns_no container_file
+ */
+int main(int argc, char ** argv){
+    char * matrix_coeff_filename = (argc > 1) ? argv[1] : (char *)"a_input_1000.txt";
+    char * free_terms_filename = (argc > 2) ? argv[2] : (char *)"free_terms_1000.txt";
+    int number_of_unknowns = (argc > 3) ? atoi(argv[3]) : 1000;
+    char * container_filename = (argc > 4) ? argv[4] : (char *)"system_1000.tsz";
+
+    std::chrono::high_resolution_clock::time_point begin = std::chrono::high_resolution_clock::now();
+    linear_system_of_equations lse = read_linear_system(matrix_coeff_filename, free_terms_filename, number_of_unknowns);
+    double text_ms = elapsed_ms(begin);
+
+    begin = std::chrono::high_resolution_clock::now();
+    if(!write_compressed_system(lse, container_filename, COMPRESSED_BLOCK_ROWS, NUM_THREADS))return 1;
+    double write_ms = elapsed_ms(begin);
+
+    begin = std::chrono::high_resolution_clock::now();
+    linear_system_of_equations loaded = read_compressed_system(container_filename, NUM_THREADS);
+    double container_ms = elapsed_ms(begin);
+    if(loaded.unknowns_no != number_of_unknowns)return 1;
+
+    long long mismatches = 0;
+    for(int row_id = 0; row_id < number_of_unknowns; row_id++){
+        if(loaded.free_terms[row_id] != lse.free_terms[row_id])mismatches++;
+        for(int col_id = row_id; col_id < number_of_unknowns; col_id++)
+            if(loaded.coefficients[row_id][col_id] != lse.coefficients[row_id][col_id])mismatches++;
+    }
+
+    long long text_bytes = file_size(matrix_coeff_filename) + file_size(free_terms_filename);
+    long long container_bytes = file_size(container_filename);
+    printf("text:      %lld bytes, loaded in %.3f ms\n", text_bytes, text_ms);
+    printf("container: %lld bytes (%.1f%% of the text), written in %.3f ms, loaded in %.3f ms\n",
+           container_bytes, 100.0 * container_bytes / text_bytes, write_ms, container_ms);
+    printf("raw packed doubles: %lld bytes; mismatching values: %lld\n",
+           (long long)sizeof(double) * ((long long)number_of_unknowns * (number_of_unknowns + 1) / 2 + number_of_unknowns), mismatches);
+
+    for(int row_id = 0; row_id < number_of_unknowns; row_id++){
+        delete[] lse.coefficients[row_id];
+        delete[] loaded.coefficients[row_id];
+    }
+    delete[] lse.coefficients;
+    delete[] loaded.coefficients;
+    delete[] lse.free_terms;
+    delete[] loaded.free_terms;
+    return mismatches == 0 ? 0 : 1;
+}
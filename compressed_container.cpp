@@ -0,0 +1,288 @@
+#include "compressed_container.h"
+#include <stdio.h>
+#include <string.h>
+
+#include <vector>
+
+struct block_table_entry {
+    long long offset;
+    long long compressed_bytes;
+};
+
+/**
+ * @brief The worst case size of the run-length encoding of raw_bytes bytes (one control byte per
+ * 128 literals).
+ */
+long long max_compressed_bytes(long long raw_bytes){
+    return raw_bytes + raw_bytes / 128 + 1;
+}
+
+/**
+ * @brief Run-length encoding. A control byte below 128 is followed by control + 1 literal bytes;
+ * a control byte c of 128 or more is followed by one byte, repeated c - 125 times (3 to 130).
+ *
+ * @return long long The number of bytes written to output
+ */
+long long run_length_encode(const unsigned char * input, long long size, unsigned char * output){
+    long long written = 0;
+    long long position = 0;
+    long long literals_start = 0;
+    while(position < size){
+        long long run = 1;
+        while(position + run < size && run < 130 && input[position + run] == input[position])run++;
+        if(run < 3 && position + run < size){
+            position += run;
+            continue;
+        }
+        if(run < 3)position += run;
+        /* Flush the literals before the run (or up to the end): */
+        while(literals_start < position){
+            long long literals = position - literals_start;
+            if(literals > 128)literals = 128;
+            output[written++] = (unsigned char)(literals - 1);
+            memcpy(output + written, input + literals_start, literals);
+            written += literals;
+            literals_start += literals;
+        }
+        if(run >= 3){
+            output[written++] = (unsigned char)(run + 125);
+            output[written++] = input[position];
+            position += run;
+            literals_start = position;
+        }
+    }
+    return written;
+}
+
+/**
+ * @brief Decode run_length_encode's output, without reading past compressed_bytes or writing past
+ * output_capacity.
+ *
+ * @return long long The number of bytes written to output, or -1 if the input is truncated or
+ * would decode to more than output_capacity bytes
+ */
+long long run_length_decode(const unsigned char * input, long long compressed_bytes, unsigned char * output, long long output_capacity){
+    long long read = 0;
+    long long written = 0;
+    while(read < compressed_bytes){
+        int control = input[read++];
+        if(control < 128){
+            if(read + control + 1 > compressed_bytes || written + control + 1 > output_capacity)return -1;
+            memcpy(output + written, input + read, control + 1);
+            read += control + 1;
+            written += control + 1;
+        }
+        else{
+            if(read >= compressed_bytes || written + control - 125 > output_capacity)return -1;
+            memset(output + written, input[read++], control - 125);
+            written += control - 125;
+        }
+    }
+    return written;
+}
+
+/**
+ * @brief The number of coefficients in rows [first_row, last_row) of the upper triangle.
+ */
+long long triangle_values(int first_row, int last_row, int n){
+    long long result = 0;
+    for(int row_id = first_row; row_id < last_row; row_id++)result += n - row_id;
+    return result;
+}
+
+/**
+ * @brief Compress one block: shuffle the bytes into planes, delta code them, run-length encode.
+ */
+std::vector<unsigned char> compress_block(linear_system_of_equations lse, int first_row, int last_row){
+    int n = lse.unknowns_no;
+    long long values = triangle_values(first_row, last_row, n);
+    std::vector<unsigned char> planes(values * sizeof(double));
+    long long value_id = 0;
+    for(int row_id = first_row; row_id < last_row; row_id++){
+        for(int col_id = row_id; col_id < n; col_id++){
+            unsigned char * bytes = (unsigned char *)&lse.coefficients[row_id][col_id];
+            for(int plane = 0; plane < (int)sizeof(double); plane++)planes[plane * values + value_id] = bytes[plane];
+            value_id++;
+        }
+    }
+    for(long long i = (long long)planes.size() - 1; i > 0; i--)planes[i] = (unsigned char)(planes[i] - planes[i - 1]);
+
+    std::vector<unsigned char> result(max_compressed_bytes(planes.size()));
+    result.resize(run_length_encode(planes.data(), planes.size(), result.data()));
+    return result;
+}
+
+/**
+ * @brief Decompress one block straight into the rows of the system.
+ *
+ * @return true If the block decodes to exactly the bytes of its rows
+ */
+bool decompress_block(const unsigned char * compressed, long long compressed_bytes, linear_system_of_equations lse, int first_row, int last_row){
+    int n = lse.unknowns_no;
+    long long values = triangle_values(first_row, last_row, n);
+    long long raw_bytes = values * sizeof(double);
+    unsigned char * planes = new unsigned char[raw_bytes];
+    if(run_length_decode(compressed, compressed_bytes, planes, raw_bytes) != raw_bytes){
+        delete[] planes;
+        return false;
+    }
+    for(long long i = 1; i < raw_bytes; i++)planes[i] = (unsigned char)(planes[i] + planes[i - 1]);
+
+    long long value_id = 0;
+    for(int row_id = first_row; row_id < last_row; row_id++){
+        for(int col_id = row_id; col_id < n; col_id++){
+            unsigned char * bytes = (unsigned char *)&lse.coefficients[row_id][col_id];
+            for(int plane = 0; plane < (int)sizeof(double); plane++)bytes[plane] = planes[plane * values + value_id];
+            value_id++;
+        }
+    }
+    delete[] planes;
+    return true;
+}
+
+/**
+ * @brief Write a system (the upper triangle and the free terms) to a container file.
+ * The blocks are compressed in parallel.
+ *
+ * @param lse The system
+ * @param container_filename The name of the container file
+ * @param rows_per_block The number of rows in each block (COMPRESSED_BLOCK_ROWS is a good default)
+ * @param number_of_threads The number of OpenMP threads that compress the blocks
+ * @return true If the file was written
+ */
+bool write_compressed_system(linear_system_of_equations lse, char * container_filename, int rows_per_block, int number_of_threads){
+    int n = lse.unknowns_no;
+    if(rows_per_block < 1)rows_per_block = COMPRESSED_BLOCK_ROWS;
+    int blocks_no = (n + rows_per_block - 1) / rows_per_block;
+
+    std::vector<std::vector<unsigned char> > blocks(blocks_no);
+    #pragma omp parallel for schedule(dynamic, 1) num_threads(number_of_threads)
+    for(int block_id = 0; block_id < blocks_no; block_id++){
+        int first_row = block_id * rows_per_block;
+        int last_row = (first_row + rows_per_block < n) ? first_row + rows_per_block : n;
+        blocks[block_id] = compress_block(lse, first_row, last_row);
+    }
+
+    FILE * file = fopen(container_filename, "wb");
+    if(file == NULL){
+        printf("Could not write the container %s\n", container_filename);
+        return false;
+    }
+    int header[3] = {n, rows_per_block, blocks_no};
+    std::vector<block_table_entry> table(blocks_no);
+    long long offset = 4 + sizeof(header) + sizeof(block_table_entry) * (long long)blocks_no + sizeof(double) * (long long)n;
+    for(int block_id = 0; block_id < blocks_no; block_id++){
+        table[block_id].offset = offset;
+        table[block_id].compressed_bytes = blocks[block_id].size();
+        offset += blocks[block_id].size();
+    }
+    fwrite(COMPRESSED_CONTAINER_MAGIC, 1, 4, file);
+    fwrite(header, sizeof(int), 3, file);
+    fwrite(table.data(), sizeof(block_table_entry), blocks_no, file);
+    fwrite(lse.free_terms, sizeof(double), n, file);
+    for(int block_id = 0; block_id < blocks_no; block_id++)fwrite(blocks[block_id].data(), 1, blocks[block_id].size(), file);
+    bool written = (ferror(file) == 0);
+    fclose(file);
+    return written;
+}
+
+/**
+ * @brief Read a container file. The file is read with one call, then the blocks are decompressed
+ * in parallel, each directly into the rows of the result (which are allocated by the thread that
+ * fills them). The rows are full rows of n values, with zeros below the diagonal, like the ones of
+ * read_linear_system. Every field of the header and every entry of the block table is checked
+ * against the size of the file before it is used, and every block must decode to exactly its rows.
+ *
+ * @param container_filename The name of the container file
+ * @param number_of_threads The number of OpenMP threads that decompress the blocks
+ * @return linear_system_of_equations The system (unknowns_no is 0 if the file is not a valid container)
+ */
+linear_system_of_equations read_compressed_system(char * container_filename, int number_of_threads){
+    linear_system_of_equations result;
+    result.coefficients = NULL;
+    result.free_terms = NULL;
+    result.unknowns_no = 0;
+
+    FILE * file = fopen(container_filename, "rb");
+    if(file == NULL){
+        printf("Could not open the container %s\n", container_filename);
+        return result;
+    }
+    fseek(file, 0, SEEK_END);
+    long long file_size = ftell(file);
+    fseek(file, 0, SEEK_SET);
+    if(file_size < 0){
+        printf("Could not read the container %s\n", container_filename);
+        fclose(file);
+        return result;
+    }
+    unsigned char * contents = new unsigned char[file_size];
+    long long read_bytes = fread(contents, 1, file_size, file);
+    fclose(file);
+
+    int header[3];
+    if(read_bytes != file_size || file_size < 4 + (long long)sizeof(header) || memcmp(contents, COMPRESSED_CONTAINER_MAGIC, 4) != 0){
+        printf("%s is not a container file\n", container_filename);
+        delete[] contents;
+        return result;
+    }
+    memcpy(header, contents + 4, sizeof(header));
+    int n = header[0];
+    int rows_per_block = header[1];
+    int blocks_no = header[2];
+    long long table_start = 4 + sizeof(header);
+    long long free_terms_start = table_start + sizeof(block_table_entry) * (long long)blocks_no;
+    long long blocks_start = free_terms_start + sizeof(double) * (long long)n;
+    /* The sizes are checked one at a time, so that none of the products above can overflow: */
+    if(n < 1 || rows_per_block < 1 || blocks_no != (n - 1) / rows_per_block + 1 || blocks_start > file_size){
+        printf("%s has an invalid header (n = %d, %d rows per block, %d blocks, %lld bytes)\n",
+               container_filename, n, rows_per_block, blocks_no, file_size);
+        delete[] contents;
+        return result;
+    }
+    block_table_entry * table = new block_table_entry[blocks_no];
+    memcpy(table, contents + table_start, sizeof(block_table_entry) * (long long)blocks_no);
+    for(int block_id = 0; block_id < blocks_no; block_id++){
+        if(table[block_id].offset < blocks_start || table[block_id].offset > file_size ||
+           table[block_id].compressed_bytes < 0 || table[block_id].compressed_bytes > file_size - table[block_id].offset){
+            printf("%s: block %d (offset %lld, %lld bytes) is outside the file\n", container_filename, block_id,
+                   table[block_id].offset, table[block_id].compressed_bytes);
+            delete[] table;
+            delete[] contents;
+            return result;
+        }
+    }
+
+    result.unknowns_no = n;
+    result.free_terms = new double[n];
+    memcpy(result.free_terms, contents + free_terms_start, sizeof(double) * (long long)n);
+    result.coefficients = new double*[n];
+
+    int invalid_block = -1;
+    #pragma omp parallel for schedule(dynamic, 1) num_threads(number_of_threads)
+    for(int block_id = 0; block_id < blocks_no; block_id++){
+        int first_row = block_id * rows_per_block;
+        int last_row = (n - first_row > rows_per_block) ? first_row + rows_per_block : n;
+        for(int row_id = first_row; row_id < last_row; row_id++){
+            result.coefficients[row_id] = new double[n];
+            for(int col_id = 0; col_id < row_id; col_id++)result.coefficients[row_id][col_id] = 0.0;
+        }
+        if(!decompress_block(contents + table[block_id].offset, table[block_id].compressed_bytes, result, first_row, last_row)){
+            #pragma omp critical
+            invalid_block = block_id;
+        }
+    }
+
+    delete[] table;
+    delete[] contents;
+    if(invalid_block >= 0){
+        printf("%s: block %d is corrupt\n", container_filename, invalid_block);
+        for(int row_id = 0; row_id < n; row_id++)delete[] result.coefficients[row_id];
+        delete[] result.coefficients;
+        delete[] result.free_terms;
+        result.coefficients = NULL;
+        result.free_terms = NULL;
+        result.unknowns_no = 0;
+    }
+    return result;
+}
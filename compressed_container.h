@@ -0,0 +1,24 @@
+#include "linear_system_schema.h"
+
+#ifndef COMPRESSED_CONTAINER_H
+#define COMPRESSED_CONTAINER_H
+
+/* The number of rows of the upper triangle compressed together: */
+#define COMPRESSED_BLOCK_ROWS 64
+/* The first bytes of a container file: */
+#define COMPRESSED_CONTAINER_MAGIC "TSZ1"
+
+/**
+ * @brief Layout of a container file (native byte order):
+ * the magic, the number of unknowns, the rows per block and the number of blocks (4 bytes each);
+ * the block table (the offset and the compressed size of each block, 8 bytes each); the free terms
+ * (raw doubles); then the blocks. A block holds the upper triangle of its rows, row after row,
+ * with the bytes of the doubles split into 8 planes, each byte delta coded against the previous one,
+ * and the result run-length encoded. Every block can be decompressed on its own.
+ */
+
+bool write_compressed_system(linear_system_of_equations lse, char * container_filename, int rows_per_block, int number_of_threads);
+
+linear_system_of_equations read_compressed_system(char * container_filename, int number_of_threads);
+
+#endif
@@ -0,0 +1,234 @@
+#include "generated_pipeline.h"
+#include <pthread.h>
+#include <sched.h>
+#include <stdlib.h>
+
+#include <atomic>
+#include <chrono>
+#include <thread>
+
+/* A waiting stage gives its core away after this many polls, so the stages may share a core: */
+#define PIPELINE_SPIN_BEFORE_YIELD 1000
+
+/**
+ * @brief A lock-free single producer, single consumer ring of blocks. The producer only writes
+ * tail, the consumer only writes head.
+ */
+struct block_ring {
+    stream_block *slots[STREAM_QUEUE_BLOCKS];
+    alignas(64) std::atomic<unsigned int> head;
+    alignas(64) std::atomic<unsigned int> tail;
+};
+
+void wait_a_little(int & polls){
+    if(++polls == PIPELINE_SPIN_BEFORE_YIELD){
+        polls = 0;
+        sched_yield();
+    }
+}
+
+void push_block(block_ring * ring, stream_block * block){
+    unsigned int tail = ring->tail.load(std::memory_order_relaxed);
+    int polls = 0;
+    while(tail - ring->head.load(std::memory_order_acquire) == STREAM_QUEUE_BLOCKS)wait_a_little(polls);
+    ring->slots[tail % STREAM_QUEUE_BLOCKS] = block;
+    ring->tail.store(tail + 1, std::memory_order_release);
+}
+
+stream_block * pop_block(block_ring * ring){
+    unsigned int head = ring->head.load(std::memory_order_relaxed);
+    int polls = 0;
+    while(ring->tail.load(std::memory_order_acquire) == head)wait_a_little(polls);
+    stream_block * block = ring->slots[head % STREAM_QUEUE_BLOCKS];
+    ring->head.store(head + 1, std::memory_order_release);
+    return block;
+}
+
+/**
+ * @brief Generate row row_id of a system: the same distribution as generate_system (with a zero
+ * diagonal replaced by 1, as generate_small_system does), but every row has its own random
+ * state, so the rows can be generated in any order.
+ *
+ * @param row The n - row_id coefficients of the row, from the diagonal
+ * @param free_term The free term of the row
+ */
+void generate_stream_row(int n, unsigned int seed, int row_id, double * row, double * free_term){
+    unsigned int state = seed * 2654435761u ^ (unsigned int)row_id * 40503u;
+    for(int i = 0; i < n - row_id; i++)row[i] = rand_r(&state) * 0.1;
+    if(row[0] == 0)row[0] = 1.0;
+    *free_term = rand_r(&state) * 0.1;
+}
+
+/**
+ * @brief The whole system that generate_and_solve_stream generates from seed, to check its results.
+ *
+ * @param n The number of unknowns
+ * @param seed The seed of the system
+ * @return linear_system_of_equations The generated system
+ */
+linear_system_of_equations generate_stream_system(int n, unsigned int seed){
+    linear_system_of_equations result;
+    result.coefficients = new double*[n];
+    result.free_terms = new double[n];
+    result.unknowns_no = n;
+    for(int row_id = 0; row_id < n; row_id++){
+        result.coefficients[row_id] = new double[n];
+        for(int col_id = 0; col_id < row_id; col_id++)result.coefficients[row_id][col_id] = 0.0;
+    }
+    fill_stream_system(result, seed);
+    return result;
+}
+
+/**
+ * @brief Overwrite the upper triangle and the free terms of lse with the system generated from
+ * seed, so that a stream of whole systems can reuse one allocation (the lower triangle is not
+ * written: it stays as generate_stream_system left it).
+ */
+void fill_stream_system(linear_system_of_equations lse, unsigned int seed){
+    int n = lse.unknowns_no;
+    for(int row_id = 0; row_id < n; row_id++)generate_stream_row(n, seed, row_id, lse.coefficients[row_id] + row_id, lse.free_terms + row_id);
+}
+
+void pin_to_cpu(int cpu){
+    unsigned int cpus_no = std::thread::hardware_concurrency();
+    if(cpu < 0 || cpus_no == 0)return;
+    cpu_set_t cpus;
+    CPU_ZERO(&cpus);
+    CPU_SET(cpu % cpus_no, &cpus);
+    pthread_setaffinity_np(pthread_self(), sizeof(cpus), &cpus);
+}
+
+/**
+ * @brief The generator stage: the systems seed, seed + 1, ..., one block at a time, from the last
+ * rows up, into free blocks taken back from the solver.
+ */
+void generator_stage(int n, int systems_no, unsigned int seed, int cpu, block_ring * free_blocks, block_ring * full_blocks){
+    pin_to_cpu(cpu);
+    for(int system_id = 0; system_id < systems_no; system_id++){
+        for(int last_row = n; last_row > 0; last_row -= STREAM_BLOCK_ROWS){
+            stream_block * block = pop_block(free_blocks);
+            block->system_id = system_id;
+            block->first_row = (last_row > STREAM_BLOCK_ROWS) ? last_row - STREAM_BLOCK_ROWS : 0;
+            block->rows_no = last_row - block->first_row;
+            double * row = block->coefficients;
+            for(int row_id = last_row - 1; row_id >= block->first_row; row_id--){
+                generate_stream_row(n, seed + system_id, row_id, row, block->free_terms + (last_row - 1 - row_id));
+                row += n - row_id;
+            }
+            push_block(full_blocks, block);
+        }
+    }
+}
+
+/**
+ * @brief The default solver stage: back-substitutes every row as soon as its block arrives (all
+ * the unknowns it needs are already known), in solution itself.
+ */
+void back_substitution_stream_consumer(const stream_block & block, int n, double * solution, void *){
+    double * row = block.coefficients;
+    int last_row = block.first_row + block.rows_no;
+    for(int i = 0; i < block.rows_no; i++){
+        int row_id = last_row - 1 - i;
+        double sum = block.free_terms[i];
+        for(int col = 1; col < n - row_id; col++)sum -= row[col] * solution[row_id + col];
+        solution[row_id] = sum / row[0];
+        row += n - row_id;
+    }
+}
+
+/**
+ * @brief The solver stage of any back-end of the library: the blocks are copied into the system
+ * of the state (a solver_stream_state), which the back-end solves once its first rows arrive.
+ */
+void solver_stream_consumer(const stream_block & block, int n, double * solution, void * state){
+    solver_stream_state * stage = (solver_stream_state *)state;
+    double * row = block.coefficients;
+    int last_row = block.first_row + block.rows_no;
+    for(int i = 0; i < block.rows_no; i++){
+        int row_id = last_row - 1 - i;
+        double * target = stage->system->row(row_id);
+        for(int col = row_id; col < n; col++)target[col] = row[col - row_id];
+        stage->system->free_terms()[row_id] = block.free_terms[i];
+        row += n - row_id;
+    }
+    if(block.first_row == 0){
+        std::vector<double> result = stage->solver->solve(*stage->system);
+        for(int sol_id = 0; sol_id < n; sol_id++)solution[sol_id] = result[sol_id];
+    }
+}
+
+/**
+ * @brief Generate and solve a stream of systems without files: a generator thread emits the
+ * rows of every system as blocks, from the last rows up, into a bounded lock-free queue, and
+ * the solver thread hands every block to the consumer as soon as it arrives. The blocks go back
+ * to the generator through a second queue, so the pipeline allocates nothing during the run.
+ *
+ * @param n The number of unknowns of every system
+ * @param systems_no The number of systems of the stream
+ * @param seed The seed of the first system; system s uses seed + s (see generate_stream_system)
+ * @param generator_cpu The core of the generator (-1 to not pin it)
+ * @param solver_cpu The core of the solver, the calling thread (-1 to not pin it); its previous
+ * affinity is restored at the end
+ * @param first_solution If not NULL, receives the n unknowns of the first system
+ * @param consumer The solver stage (back_substitution_stream_consumer, solver_stream_consumer, ...)
+ * @param consumer_state The state passed to the consumer
+ * @return stream_throughput The throughput of the run
+ */
+stream_throughput generate_and_solve_stream(int n, int systems_no, unsigned int seed, int generator_cpu, int solver_cpu, double * first_solution,
+                                            stream_block_consumer consumer, void * consumer_state){
+    /* A block never holds more than STREAM_BLOCK_ROWS full rows: */
+    size_t block_capacity = (size_t)STREAM_BLOCK_ROWS * n;
+    stream_block blocks[STREAM_QUEUE_BLOCKS];
+    block_ring free_blocks;
+    block_ring full_blocks;
+    free_blocks.head.store(0);
+    free_blocks.tail.store(0);
+    full_blocks.head.store(0);
+    full_blocks.tail.store(0);
+    for(int block_id = 0; block_id < STREAM_QUEUE_BLOCKS; block_id++){
+        blocks[block_id].coefficients = new double[block_capacity];
+        blocks[block_id].free_terms = new double[STREAM_BLOCK_ROWS];
+        push_block(&free_blocks, &blocks[block_id]);
+    }
+
+    double * solution = new double[n];
+    double checksum = 0.0;
+    std::chrono::high_resolution_clock::time_point begin = std::chrono::high_resolution_clock::now();
+    std::thread generator(generator_stage, n, systems_no, seed, generator_cpu, &free_blocks, &full_blocks);
+    cpu_set_t previous_cpus;
+    bool restore_cpus = solver_cpu >= 0 && pthread_getaffinity_np(pthread_self(), sizeof(previous_cpus), &previous_cpus) == 0;
+    pin_to_cpu(solver_cpu);
+
+    for(int system_id = 0; system_id < systems_no; system_id++){
+        int next_row = n;
+        while(next_row > 0){
+            stream_block * block = pop_block(&full_blocks);
+            consumer(*block, n, solution, consumer_state);
+            next_row = block->first_row;
+            push_block(&free_blocks, block);
+        }
+        for(int sol_id = 0; sol_id < n; sol_id++)checksum += solution[sol_id];
+        if(system_id == 0 && first_solution != NULL)
+            for(int sol_id = 0; sol_id < n; sol_id++)first_solution[sol_id] = solution[sol_id];
+    }
+
+    generator.join();
+    std::chrono::high_resolution_clock::time_point end = std::chrono::high_resolution_clock::now();
+    /* Give the calling thread the cores it had: */
+    if(restore_cpus)pthread_setaffinity_np(pthread_self(), sizeof(previous_cpus), &previous_cpus);
+
+    stream_throughput result;
+    result.systems_no = systems_no;
+    result.unknowns_no = n;
+    result.seconds = std::chrono::duration_cast<std::chrono::nanoseconds>(end - begin).count() * 1e-9;
+    result.systems_per_second = systems_no / result.seconds;
+    result.bytes_per_second = (double)systems_no * ((double)n * (n + 1) / 2 + n) * sizeof(double) / result.seconds;
+    result.checksum = checksum;
+
+    for(int block_id = 0; block_id < STREAM_QUEUE_BLOCKS; block_id++){
+        delete[] blocks[block_id].coefficients;
+        delete[] blocks[block_id].free_terms;
+    }
+    delete[] solution;
+    return result;
+}
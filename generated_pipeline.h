@@ -0,0 +1,65 @@
+#include "linear_system_schema.h"
+#include "solver_library.h"
+
+#ifndef GENERATED_PIPELINE_H
+#define GENERATED_PIPELINE_H
+
+/* The number of rows of a block, the unit that moves from the generator to the solver: */
+#define STREAM_BLOCK_ROWS 32
+/* The number of blocks in flight between the two stages (a power of two): */
+#define STREAM_QUEUE_BLOCKS 16
+
+/**
+ * @brief Rows first_row .. first_row + rows_no - 1 of system system_id, stored from the last one
+ * up. Every row holds its n - row coefficients, starting with the diagonal.
+ */
+struct stream_block {
+    double *coefficients;
+    double *free_terms;
+    int system_id;
+    int first_row;
+    int rows_no;
+};
+
+/**
+ * @brief The solver stage of a stream. It is called on the solver's core with every block, in
+ * the order of the stream: the systems one after the other, the blocks of a system from the last
+ * rows up. The block only lives during the call. Once it has consumed the block with first_row 0,
+ * the consumer must have written the n unknowns of the system to solution.
+ */
+typedef void (*stream_block_consumer)(const stream_block & block, int n, double * solution, void * state);
+
+/**
+ * @brief The state of solver_stream_consumer: the back-end, and a system of the stream's n
+ * unknowns (TriangularSystem(n), whose lower triangle stays 0) that the blocks are copied into.
+ */
+struct solver_stream_state {
+    const Solver *solver;
+    TriangularSystem *system;
+};
+
+/**
+ * @brief The result of a throughput run over a stream of generated systems. The bytes are the
+ * coefficients and free terms that went through the queue.
+ */
+struct stream_throughput {
+    int systems_no;
+    int unknowns_no;
+    double seconds;
+    double systems_per_second;
+    double bytes_per_second;
+    double checksum;
+};
+
+linear_system_of_equations generate_stream_system(int n, unsigned int seed);
+
+void fill_stream_system(linear_system_of_equations lse, unsigned int seed);
+
+void back_substitution_stream_consumer(const stream_block & block, int n, double * solution, void * state);
+
+void solver_stream_consumer(const stream_block & block, int n, double * solution, void * state);
+
+stream_throughput generate_and_solve_stream(int n, int systems_no, unsigned int seed, int generator_cpu, int solver_cpu, double * first_solution,
+                                            stream_block_consumer consumer = back_substitution_stream_consumer, void * consumer_state = NULL);
+
+#endif
@@ -1,98 +1,36 @@
 #include <stdio.h>
 #include <stdlib.h>
-#include <fstream>
+#include <math.h>
 #include <mpi.h>
+#include <omp.h>
 #include <chrono>
 
+#include "solver_library.h"
+
 #define NUM_OMP_THREADS 4
 
 using namespace std;
 
-struct linear_system_of_equations {
-    double **coefficients;
-    double *free_terms;
-    int unknowns_no;
-};
-
-/**
- * @brief 
- * 
- * @param coeff_filename 
- * @return int** 
- */
-double** read_coeff_matrix(char * coeff_filename, int unknowns_no){
-    std::ifstream coeff_file(coeff_filename);
-    // read the number of unknowns:
-    double ** result = new double*[unknowns_no];
-    for(int row_id = 0; row_id < unknowns_no; row_id ++){
-        // read the equations:
-        result[row_id] = new double[unknowns_no];
-        for(int i = 0;i < row_id;i++)result[row_id][i] = 0.0;
-        for(int col_id = row_id; col_id < unknowns_no; col_id++){
-            coeff_file >> result[row_id][col_id];
-            result[row_id][col_id] = result[row_id][col_id]  * 0.01;
-            if(result[row_id][col_id] == 0)result[row_id][col_id] = 1.0;
-        }
-    }
-    coeff_file.close();
-    return result;
-}
-
-/**
- * @brief 
- * 
- * @param free_term_filename 
- * @param unknowns_no 
- * @return double* 
- */
-double * read_free_terms(char * free_term_filename, int unknowns_no){
-    std::ifstream free_tearm_file(free_term_filename);
-    // read the values:
-    double * result = new double[unknowns_no];
-    for(int eq_id = 0; eq_id < unknowns_no; eq_id ++){
-        free_tearm_file >> result[eq_id];
-        if(result[eq_id] == 0)result[eq_id] = 1000.0;
-    }
-    free_tearm_file.close();
-    return result;
-}
+const int ROWS_TAG = 0;
 
 /**
- * @brief 
- * 
- * @param filename 
- * @return int 
+ * @brief The first row of the block of a rank: the ranks own contiguous blocks of rows, of sizes
+ * that differ by at most one.
  */
-int read_unknown_no(char * filename){
-    int result = 0;
-    std::ifstream unknowns_no_file(filename);
-    unknowns_no_file >> result;
-    unknowns_no_file.close();
-    return result;
+int block_begin(int n, int rank, int world_size){
+    return (int)((long long)n * rank / world_size);
 }
 
 /**
- * @brief 
- * 
- * @param coeff_filename 
- * @param free_terms_filename 
- * @param no_unknowns 
- * @return linear_system_of_equations 
+ * @brief The hybrid solver: MPI between the blocks of rows, OpenMP inside a rank. From the last
+ * block up, the owner of a block solves its diagonal block with the OpenMP back-end of the library
+ * and broadcasts its unknowns; every rank above it then subtracts them from the sums of its rows,
+ * with its OpenMP threads.
  */
-linear_system_of_equations read_linear_system(char * coeff_filename, char * free_terms_filename, char * unknown_no_filename){
-    linear_system_of_equations result;
-    result.unknowns_no = read_unknown_no(unknown_no_filename);
-    result.coefficients = read_coeff_matrix(coeff_filename, result.unknowns_no);
-    result.free_terms = read_free_terms(free_terms_filename, result.unknowns_no);
-    return result;
-}
-
-
 void solution1(){
-    linear_system_of_equations lse;
-    char * matrix_coeff_filename = "a_input_10.txt";
-    char * free_terms_filename = "free_terms_10.txt";
-    char * unknown_num_filename = "unknown_no_10.txt";
+    const char * matrix_coeff_filename = "a_input_10.txt";
+    const char * free_terms_filename = "free_terms_10.txt";
+    const char * unknown_num_filename = "unknown_no_10.txt";
     MPI_Init(NULL, NULL);
     double absolute_begin = MPI_Wtime();
 
@@ -101,47 +39,77 @@ void solution1(){
     int world_size;
     MPI_Comm_size(MPI_COMM_WORLD, &world_size);
 
-    /* The thread with rank 0 will read the linear system of equations and will share the result with the other threads: */
-    if(world_rank == 0){
-        lse.unknowns_no = read_unknown_no(unknown_num_filename);
-    }
-    MPI_Bcast(&lse.unknowns_no, 1, MPI_INT, 0, MPI_COMM_WORLD);
-    if(world_rank == 0){
-        lse.coefficients = read_coeff_matrix(matrix_coeff_filename, lse.unknowns_no);
-        lse.free_terms = read_free_terms(free_terms_filename, lse.unknowns_no);
-    }
-    else{
-        lse.coefficients = new double*[lse.unknowns_no];
-        lse.free_terms = new double[lse.unknowns_no];
-    }
-    MPI_Bcast(lse.free_terms, lse.unknowns_no, MPI_DOUBLE, 0, MPI_COMM_WORLD);
-    for(int row_index = 0; row_index < lse.unknowns_no; row_index ++){
-        if(world_rank != 0){
-            lse.coefficients[row_index] = new double[lse.unknowns_no];
+    /* The thread with rank 0 will read the linear system of equations and will send every rank its rows: */
+    int n = 0;
+    if(world_rank == 0)n = read_unknowns_no(unknown_num_filename);
+    MPI_Bcast(&n, 1, MPI_INT, 0, MPI_COMM_WORLD);
+    TriangularSystem system(0);
+    if(world_rank == 0)system = TriangularSystem::read(matrix_coeff_filename, free_terms_filename, unknown_num_filename);
+
+    int first_row = block_begin(n, world_rank, world_size);
+    int last_row = block_begin(n, world_rank + 1, world_size);
+    double ** rows = new double*[n];
+    double * sum = new double[n];
+    if(world_rank == 0)for(int row_id = 0; row_id < n; row_id++)sum[row_id] = system.free_terms()[row_id];
+    MPI_Bcast(sum, n, MPI_DOUBLE, 0, MPI_COMM_WORLD);
+    for(int rank = 0; rank < world_size; rank++){
+        for(int row_id = block_begin(n, rank, world_size); row_id < block_begin(n, rank + 1, world_size); row_id++){
+            if(world_rank == rank)rows[row_id] = (world_rank == 0) ? system.row(row_id) : new double[n];
+            if(rank == 0)continue;
+            if(world_rank == 0)MPI_Send(system.row(row_id), n, MPI_DOUBLE, rank, ROWS_TAG, MPI_COMM_WORLD);
+            else if(world_rank == rank)MPI_Recv(rows[row_id], n, MPI_DOUBLE, 0, ROWS_TAG, MPI_COMM_WORLD, MPI_STATUS_IGNORE);
         }
-        MPI_Bcast(lse.coefficients[row_index], lse.unknowns_no, MPI_DOUBLE, 0, MPI_COMM_WORLD);
     }
 
-    int solved_index = 0;
-    int solution_index = 0;
-    int thread_index = 0;
-    int start_index = 0;
-
-    double * solution = new double[lse.unknowns_no];
-    double * sum = new double[lse.unknowns_no];
+    std::unique_ptr<Solver> solver = make_solver(OPEN_MP_BACKEND, NUM_OMP_THREADS);
+    double * solution = new double[n];
+    double begin = MPI_Wtime();
 
     /* Solve the system: */
-    for(solved_index = lse.unknowns_no - 1; solved_index > -1; solved_index --){
-        #pragma omp parallel default(none) private(thread_index, solution_index, start_index) shared(solved_index, lse, solution, sum) num_threads(NUM_OMP_THREADS)
-        {
-            thread_index = omp_get_thread_num();
-            if(world_rank == 0){
-
+    for(int rank = world_size - 1; rank > -1; rank--){
+        int block_first = block_begin(n, rank, world_size);
+        int block_last = block_begin(n, rank + 1, world_size);
+        if(block_first == block_last)continue;
+        if(world_rank == rank){
+            /* A view of the diagonal block, whose free terms are the sums of its rows: */
+            linear_system_of_equations block;
+            block.unknowns_no = block_last - block_first;
+            block.coefficients = new double*[block.unknowns_no];
+            for(int i = 0; i < block.unknowns_no; i++)block.coefficients[i] = rows[block_first + i] + block_first;
+            block.free_terms = sum + block_first;
+            double * block_solution = solver->solve_system(block);
+            for(int i = 0; i < block.unknowns_no; i++)solution[block_first + i] = block_solution[i];
+            delete[] block_solution;
+            delete[] block.coefficients;
+        }
+        MPI_Bcast(solution + block_first, block_last - block_first, MPI_DOUBLE, rank, MPI_COMM_WORLD);
+
+        if(world_rank < rank){
+            #pragma omp parallel for schedule(static) num_threads(NUM_OMP_THREADS)
+            for(int row_id = first_row; row_id < last_row; row_id++){
+                double value = 0.0;
+                for(int col_id = block_first; col_id < block_last; col_id++)value += rows[row_id][col_id] * solution[col_id];
+                sum[row_id] -= value;
             }
-            MPI_Barrier();
         }
     }
 
+    double end = MPI_Wtime();
+    if(world_rank == 0){
+        /* Check the result against the sequential back-end: */
+        std::vector<double> expected = make_solver(SEQUENTIAL_BACKEND, 1)->solve(system);
+        double max_difference = 0.0;
+        for(int row_id = 0; row_id < n; row_id++)
+            if(fabs(solution[row_id] - expected[row_id]) > max_difference)max_difference = fabs(solution[row_id] - expected[row_id]);
+        printf("n = %d, %d ranks x %d threads\n", n, world_size, NUM_OMP_THREADS);
+        printf("solve time = %f s, total time = %f s\n", end - begin, end - absolute_begin);
+        printf("max difference from the sequential solution = %e\n", max_difference);
+    }
+
+    if(world_rank != 0)for(int row_id = first_row; row_id < last_row; row_id++)delete[] rows[row_id];
+    delete[] rows;
+    delete[] sum;
+    delete[] solution;
     MPI_Finalize();
 }
 
@@ -150,4 +118,4 @@ int main(){
     solution1();
 
     return 0;
-}
\ No newline at end of file
+}
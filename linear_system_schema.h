@@ -8,4 +8,12 @@ struct linear_system_of_equations {
     int unknowns_no;
 };
 
+/**
+ * @brief How the values of the text files are read. READER_CONVENTION is the one of the
+ * assignment programs and of read_linear_system: the coefficients are scaled by 0.01, a zero
+ * coefficient is read as 1 and a zero free term as 1000. RAW_COEFFICIENTS keeps the values
+ * (and the zeros) of the files.
+ */
+enum coefficient_convention { READER_CONVENTION, RAW_COEFFICIENTS };
+
 #endif
\ No newline at end of file
@@ -0,0 +1,168 @@
+#include "lu_factorization.h"
+#include "recursive_solver.h"
+#include "triangular_solver.h"
+#include <math.h>
+
+/**
+ * @brief Factorize the panel of columns [first_col, last_col), rows [first_col, n), with partial
+ * pivoting. The row exchanges swap the row pointers, so they also apply to the columns on the
+ * left (L) and on the right (the trailing matrix) of the panel at no cost.
+ */
+void factorize_panel(double ** a, int * permutation, int n, int first_col, int last_col){
+    for(int col_id = first_col; col_id < last_col; col_id++){
+        /* Partial pivoting: */
+        int pivot_row = col_id;
+        for(int row_id = col_id + 1; row_id < n; row_id++){
+            if(fabs(a[row_id][col_id]) > fabs(a[pivot_row][col_id]))pivot_row = row_id;
+        }
+        if(pivot_row != col_id){
+            double * row = a[pivot_row];
+            a[pivot_row] = a[col_id];
+            a[col_id] = row;
+            int original_row = permutation[pivot_row];
+            permutation[pivot_row] = permutation[col_id];
+            permutation[col_id] = original_row;
+        }
+
+        double pivot = a[col_id][col_id];
+        if(pivot == 0)continue;
+
+        /* Compute the column of L and update the rest of the panel, a task for every block of rows: */
+        #pragma omp taskloop grainsize(LU_BLOCK_SIZE) default(none) shared(a) firstprivate(col_id, last_col, pivot)
+        for(int row_id = col_id + 1; row_id < n; row_id++){
+            double * row = a[row_id];
+            double * pivot_row_values = a[col_id];
+            row[col_id] /= pivot;
+            double multiplier = row[col_id];
+            for(int k = col_id + 1; k < last_col; k++)row[k] -= multiplier * pivot_row_values[k];
+        }
+    }
+}
+
+/**
+ * @brief U12 = L11^-1 * A12, for the rows of the panel and the columns on its right.
+ * The columns are independent, so every block of columns is a task.
+ */
+void update_panel_rows(double ** a, int n, int first_col, int last_col){
+    #pragma omp taskloop grainsize(LU_BLOCK_SIZE) default(none) shared(a) firstprivate(first_col, last_col)
+    for(int col_id = last_col; col_id < n; col_id++){
+        for(int row_id = first_col + 1; row_id < last_col; row_id++){
+            double value = a[row_id][col_id];
+            for(int k = first_col; k < row_id; k++)value -= a[row_id][k] * a[k][col_id];
+            a[row_id][col_id] = value;
+        }
+    }
+}
+
+/**
+ * @brief A22 -= L21 * U12, one task for every tile of LU_BLOCK_SIZE x LU_BLOCK_SIZE.
+ */
+void update_trailing_matrix(double ** a, int n, int first_col, int last_col){
+    #pragma omp taskloop collapse(2) default(none) shared(a) firstprivate(n, first_col, last_col)
+    for(int tile_row = last_col; tile_row < n; tile_row += LU_BLOCK_SIZE){
+        for(int tile_col = last_col; tile_col < n; tile_col += LU_BLOCK_SIZE){
+            int row_end = (tile_row + LU_BLOCK_SIZE < n) ? tile_row + LU_BLOCK_SIZE : n;
+            int col_end = (tile_col + LU_BLOCK_SIZE < n) ? tile_col + LU_BLOCK_SIZE : n;
+            for(int row_id = tile_row; row_id < row_end; row_id++){
+                double * row = a[row_id];
+                for(int k = first_col; k < last_col; k++){
+                    double multiplier = row[k];
+                    double * u_row = a[k];
+                    for(int col_id = tile_col; col_id < col_end; col_id++)row[col_id] -= multiplier * u_row[col_id];
+                }
+            }
+        }
+    }
+}
+
+/**
+ * @brief Blocked, right-looking LU factorization with partial pivoting of a general dense matrix.
+ * For every panel: factorize the panel, compute the block row of U, then update the trailing
+ * matrix; each phase is split in OpenMP tasks.
+ *
+ * @param lse The system; all the n x n coefficients are used, and they are not modified
+ * @param number_of_threads The number of OpenMP threads
+ * @return lu_factorization The factors; L and U can be used by forward_substitution and lu_upper_system
+ */
+lu_factorization lu_factorize(linear_system_of_equations lse, int number_of_threads){
+    int n = lse.unknowns_no;
+    lu_factorization result;
+    result.unknowns_no = n;
+    result.lu = new double*[n];
+    result.permutation = new int[n];
+    for(int row_id = 0; row_id < n; row_id++){
+        result.lu[row_id] = new double[n];
+        for(int col_id = 0; col_id < n; col_id++)result.lu[row_id][col_id] = lse.coefficients[row_id][col_id];
+        result.permutation[row_id] = row_id;
+    }
+
+    double ** a = result.lu;
+    int * permutation = result.permutation;
+    #pragma omp parallel default(none) shared(a, permutation, n) num_threads(number_of_threads)
+    #pragma omp single
+    {
+        for(int first_col = 0; first_col < n; first_col += LU_BLOCK_SIZE){
+            int last_col = (first_col + LU_BLOCK_SIZE < n) ? first_col + LU_BLOCK_SIZE : n;
+            factorize_panel(a, permutation, n, first_col, last_col);
+            update_panel_rows(a, n, first_col, last_col);
+            update_trailing_matrix(a, n, first_col, last_col);
+        }
+    }
+    return result;
+}
+
+/**
+ * @brief Solve L * y = P * b; L has a unit diagonal.
+ *
+ * @param factorization The LU factorization
+ * @param free_terms The free terms b, in the original row order
+ * @param number_of_threads The number of OpenMP threads
+ * @return double* The solution y, which is the right hand side of U * x = y
+ */
+double * forward_substitution(lu_factorization factorization, double * free_terms, int number_of_threads){
+    int n = factorization.unknowns_no;
+    double * result = new double[n];
+    for(int row_id = 0; row_id < n; row_id++)result[row_id] = free_terms[factorization.permutation[row_id]];
+    triangular_solve<LOWER_TRIANGLE, NO_TRANSPOSE, UNIT_DIAGONAL>(factorization.lu, result, n, number_of_threads);
+    return result;
+}
+
+/**
+ * @brief The upper triangular system U * x = y, in the format used by the back-substitution solvers.
+ * The coefficients are the rows of the factorization (the solvers never read below the diagonal),
+ * so the system must not outlive the factorization, and must not be freed on its own.
+ *
+ * @param factorization The LU factorization
+ * @param forward_solution The solution of forward_substitution
+ * @return linear_system_of_equations The upper triangular system
+ */
+linear_system_of_equations lu_upper_system(lu_factorization factorization, double * forward_solution){
+    linear_system_of_equations result;
+    result.coefficients = factorization.lu;
+    result.free_terms = forward_solution;
+    result.unknowns_no = factorization.unknowns_no;
+    return result;
+}
+
+/**
+ * @brief Solve a general dense system: LU factorization, forward substitution, then the
+ * (recursive, parallel) back-substitution.
+ *
+ * @param lse The general dense system
+ * @param number_of_threads The number of OpenMP threads
+ * @return double* The solution of the system
+ */
+double * lu_system_solver(linear_system_of_equations lse, int number_of_threads){
+    lu_factorization factorization = lu_factorize(lse, number_of_threads);
+    double * forward_solution = forward_substitution(factorization, lse.free_terms, number_of_threads);
+    double * solution = recursive_system_solver(lu_upper_system(factorization, forward_solution), number_of_threads);
+    delete[] forward_solution;
+    free_lu_factorization(factorization);
+    return solution;
+}
+
+void free_lu_factorization(lu_factorization factorization){
+    for(int row_id = 0; row_id < factorization.unknowns_no; row_id++)delete[] factorization.lu[row_id];
+    delete[] factorization.lu;
+    delete[] factorization.permutation;
+}
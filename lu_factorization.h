@@ -0,0 +1,30 @@
+#include "linear_system_schema.h"
+
+#ifndef LU_FACTORIZATION_H
+#define LU_FACTORIZATION_H
+
+/* The width of the panels of the blocked factorization, and the size of the update tiles: */
+#define LU_BLOCK_SIZE 64
+
+/**
+ * @brief The factorization P * A = L * U of a general dense matrix. Both factors share the
+ * rows of lu: L (unit diagonal, not stored) below the diagonal, U on and above it.
+ * Row i of P * A is row permutation[i] of A.
+ */
+struct lu_factorization {
+    double **lu;
+    int *permutation;
+    int unknowns_no;
+};
+
+lu_factorization lu_factorize(linear_system_of_equations lse, int number_of_threads);
+
+double * forward_substitution(lu_factorization factorization, double * free_terms, int number_of_threads);
+
+linear_system_of_equations lu_upper_system(lu_factorization factorization, double * forward_solution);
+
+double * lu_system_solver(linear_system_of_equations lse, int number_of_threads);
+
+void free_lu_factorization(lu_factorization factorization);
+
+#endif
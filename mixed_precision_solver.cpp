@@ -0,0 +1,221 @@
+#include "mixed_precision_solver.h"
+#include <math.h>
+#include <float.h>
+
+/**
+ * @brief Build a single precision copy of the upper triangle of the coefficient matrix.
+ * The copy is packed column by column (column j holds the rows 0..j, with the diagonal
+ * element last), so the "push" updates of the back-substitution read it contiguously.
+ *
+ * @param lse The linear system of equations
+ * @param matrix_norm Output: the infinity norm of the (double precision) coefficient matrix
+ * @return float* The packed single precision upper triangle
+ */
+float * pack_upper_triangle_as_float(linear_system_of_equations lse, double * matrix_norm){
+    int n = lse.unknowns_no;
+    float * packed = new float[(long long)n * (n + 1) / 2];
+    double * row_norm = new double[n];
+    for(int row_id = 0; row_id < n; row_id++)row_norm[row_id] = 0.0;
+
+    for(int col_id = 0; col_id < n; col_id++){
+        float * column = packed + (long long)col_id * (col_id + 1) / 2;
+        for(int row_id = 0; row_id <= col_id; row_id++){
+            column[row_id] = (float)lse.coefficients[row_id][col_id];
+            row_norm[row_id] += fabs(lse.coefficients[row_id][col_id]);
+        }
+    }
+
+    *matrix_norm = 0.0;
+    for(int row_id = 0; row_id < n; row_id++)if(row_norm[row_id] > *matrix_norm)*matrix_norm = row_norm[row_id];
+    delete[] row_norm;
+    return packed;
+}
+
+/**
+ * @brief Solve U * x = rhs in single precision, using the packed copy of U.
+ * On return, rhs has been overwritten (it is used as the array of partial sums).
+ *
+ * @param packed The column-packed single precision upper triangle
+ * @param rhs The right hand side; destroyed by the call
+ * @param x Output: the single precision solution
+ * @param n The number of unknowns
+ */
+void float_back_substitution(float * packed, float * rhs, float * x, int n){
+    for(int solved_index = n - 1; solved_index > -1; solved_index--){
+        float * column = packed + (long long)solved_index * (solved_index + 1) / 2;
+        if(column[solved_index] != 0)x[solved_index] = rhs[solved_index] / column[solved_index];
+        else x[solved_index] = 0;
+        float value = x[solved_index];
+        for(int sum_index = 0; sum_index < solved_index; sum_index++)rhs[sum_index] -= column[sum_index] * value;
+    }
+}
+
+/**
+ * @brief The OpenMP version of float_back_substitution: every unknown is solved by a
+ * single thread, then the update of the remaining partial sums is split between the threads.
+ *
+ * @param packed The column-packed single precision upper triangle
+ * @param rhs The right hand side; destroyed by the call
+ * @param x Output: the single precision solution
+ * @param n The number of unknowns
+ * @param number_of_threads The number of OpenMP threads
+ */
+void float_back_substitution_omp(float * packed, float * rhs, float * x, int n, int number_of_threads){
+    #pragma omp parallel default(none) shared(packed, rhs, x, n) num_threads(number_of_threads)
+    {
+        for(int solved_index = n - 1; solved_index > -1; solved_index--){
+            float * column = packed + (long long)solved_index * (solved_index + 1) / 2;
+            #pragma omp single
+            {
+                if(column[solved_index] != 0)x[solved_index] = rhs[solved_index] / column[solved_index];
+                else x[solved_index] = 0;
+            }
+            float value = x[solved_index];
+            #pragma omp for schedule(static)
+            for(int sum_index = 0; sum_index < solved_index; sum_index++)rhs[sum_index] -= column[sum_index] * value;
+        }
+    }
+}
+
+/**
+ * @brief Compute the residual r = b - U * x in double precision, against the original matrix.
+ *
+ * @param lse The linear system of equations
+ * @param x The current approximation of the solution
+ * @param residual Output: the residual
+ * @param number_of_threads The number of OpenMP threads (1 for the sequential solver)
+ * @return double The infinity norm of the residual
+ */
+double compute_residual(linear_system_of_equations lse, double * x, double * residual, int number_of_threads){
+    int n = lse.unknowns_no;
+    double residual_norm = 0.0;
+    #pragma omp parallel for schedule(dynamic, 16) reduction(max:residual_norm) num_threads(number_of_threads)
+    for(int row_id = 0; row_id < n; row_id++){
+        double value = lse.free_terms[row_id];
+        double * row = lse.coefficients[row_id];
+        for(int col_id = row_id; col_id < n; col_id++)value -= row[col_id] * x[col_id];
+        residual[row_id] = value;
+        if(fabs(value) > residual_norm)residual_norm = fabs(value);
+    }
+    return residual_norm;
+}
+
+/**
+ * @brief Pack the single precision copy of the matrix, for mixed_precision_prepared_solver.
+ *
+ * @param lse The linear system of equations; its matrix must stay alive and unchanged while the
+ * result is used
+ * @return mixed_precision_system The system with its packed copy
+ */
+mixed_precision_system prepare_mixed_precision_system(linear_system_of_equations lse){
+    mixed_precision_system result;
+    result.lse = lse;
+    result.packed = pack_upper_triangle_as_float(lse, &result.matrix_norm);
+    return result;
+}
+
+/**
+ * @brief Solve the system in single precision and refine the solution with double precision
+ * residuals, until the residual reaches the double precision rounding floor (at most
+ * MAX_REFINEMENT_STEPS steps, fewer if the refinement stagnates). The residual is computed once
+ * more after the last correction, so the returned solution has always been checked. The
+ * back-substitutions only read the float copy of the matrix, but every residual streams the
+ * double matrix: see mixed_precision_bytes_moved for what a solve costs in memory traffic.
+ *
+ * @param mps The system with its packed copy; the free terms are mps->lse.free_terms
+ * @param number_of_threads The number of OpenMP threads; 1 means a purely sequential solve
+ * @param refinement_steps Output: the number of refinement steps that have been performed
+ * @return double* The solution of the system
+ */
+double * mixed_precision_prepared_solver(mixed_precision_system * mps, int number_of_threads, int * refinement_steps){
+    linear_system_of_equations lse = mps->lse;
+    int n = lse.unknowns_no;
+    float * packed = mps->packed;
+    double matrix_norm = mps->matrix_norm;
+
+    double * solution = new double[n];
+    double * residual = new double[n];
+    float * rhs = new float[n];
+    float * correction = new float[n];
+
+    double free_terms_norm = 0.0;
+    for(int row_id = 0; row_id < n; row_id++){
+        rhs[row_id] = (float)lse.free_terms[row_id];
+        if(fabs(lse.free_terms[row_id]) > free_terms_norm)free_terms_norm = fabs(lse.free_terms[row_id]);
+    }
+
+    /* The initial, single precision, solution: */
+    if(number_of_threads > 1)float_back_substitution_omp(packed, rhs, correction, n, number_of_threads);
+    else float_back_substitution(packed, rhs, correction, n);
+    for(int row_id = 0; row_id < n; row_id++)solution[row_id] = correction[row_id];
+
+    *refinement_steps = 0;
+    double previous_norm = HUGE_VAL;
+    while(true){
+        double residual_norm = compute_residual(lse, solution, residual, number_of_threads);
+        double solution_norm = 0.0;
+        for(int row_id = 0; row_id < n; row_id++)if(fabs(solution[row_id]) > solution_norm)solution_norm = fabs(solution[row_id]);
+        /* Stop at the rounding floor of the double precision residual, when the refinement
+         * stagnates, or once the last allowed correction has been checked: */
+        if(residual_norm <= REFINEMENT_TOLERANCE_FACTOR * n * DBL_EPSILON * (matrix_norm * solution_norm + free_terms_norm))break;
+        if(residual_norm >= 0.5 * previous_norm)break;
+        if(*refinement_steps == MAX_REFINEMENT_STEPS)break;
+        previous_norm = residual_norm;
+
+        for(int row_id = 0; row_id < n; row_id++)rhs[row_id] = (float)residual[row_id];
+        if(number_of_threads > 1)float_back_substitution_omp(packed, rhs, correction, n, number_of_threads);
+        else float_back_substitution(packed, rhs, correction, n);
+        for(int row_id = 0; row_id < n; row_id++)solution[row_id] += correction[row_id];
+        *refinement_steps += 1;
+    }
+
+    delete[] residual;
+    delete[] rhs;
+    delete[] correction;
+    return solution;
+}
+
+void free_mixed_precision_system(mixed_precision_system mps){
+    delete[] mps.packed;
+}
+
+/**
+ * @brief A single solve: pack the float copy, solve and refine, then drop the copy.
+ */
+double * mixed_precision_solver(linear_system_of_equations lse, int number_of_threads, int * refinement_steps){
+    mixed_precision_system mps = prepare_mixed_precision_system(lse);
+    double * solution = mixed_precision_prepared_solver(&mps, number_of_threads, refinement_steps);
+    free_mixed_precision_system(mps);
+    return solution;
+}
+
+double * mixed_precision_sequential_solver(linear_system_of_equations lse, int * refinement_steps){
+    return mixed_precision_solver(lse, 1, refinement_steps);
+}
+
+double * mixed_precision_open_mp_solver(linear_system_of_equations lse, int number_of_threads, int * refinement_steps){
+    return mixed_precision_solver(lse, number_of_threads, refinement_steps);
+}
+
+/**
+ * @brief The bytes of matrix a mixed precision solve moves: the packing reads the double triangle
+ * and writes the float one, the first solve and every correction read the float triangle, and
+ * every pass of the refinement loop (one more than the corrections: the last one only checks)
+ * reads the double triangle for its residual.
+ * A plain double solve reads the double triangle once, 8 bytes per coefficient. Even with the
+ * packed copy reused, a mixed precision solve reads 4 + 8 bytes per coefficient before its first
+ * correction and 4 + 8 more per correction: the mode does not save memory traffic, it trades
+ * bandwidth for single precision arithmetic (twice the SIMD width), and only pays off where the
+ * float solves are compute-bound.
+ *
+ * @param n The number of unknowns
+ * @param refinement_steps The number of refinement steps of the solve
+ * @return long long The number of bytes
+ */
+long long mixed_precision_bytes_moved(int n, int refinement_steps){
+    long long coefficients = (long long)n * (n + 1) / 2;
+    long long packing = coefficients * (sizeof(double) + sizeof(float));
+    long long float_solves = coefficients * sizeof(float) * (1 + refinement_steps);
+    long long residuals = coefficients * sizeof(double) * (1 + refinement_steps);
+    return packing + float_solves + residuals;
+}
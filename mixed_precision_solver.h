@@ -0,0 +1,36 @@
+#include "linear_system_schema.h"
+
+#ifndef MIXED_PRECISION_SOLVER_H
+#define MIXED_PRECISION_SOLVER_H
+
+/* One refinement step brings a well-conditioned float solution within a few times the double
+ * rounding floor and a second one reaches it; the cap leaves room for less well-conditioned
+ * systems, which the stagnation test stops anyway: */
+#define MAX_REFINEMENT_STEPS 4
+/* The refinement stops once the residual is below this many times n * DBL_EPSILON * (|U||x| + |b|),
+ * the rounding floor of a residual computed in double precision: */
+#define REFINEMENT_TOLERANCE_FACTOR 2
+
+/**
+ * @brief A system together with the single precision copy of its matrix. The copy is packed once
+ * by prepare_mixed_precision_system and reused by every solve.
+ */
+struct mixed_precision_system {
+    linear_system_of_equations lse;
+    float *packed;
+    double matrix_norm;
+};
+
+mixed_precision_system prepare_mixed_precision_system(linear_system_of_equations lse);
+
+double * mixed_precision_prepared_solver(mixed_precision_system * mps, int number_of_threads, int * refinement_steps);
+
+void free_mixed_precision_system(mixed_precision_system mps);
+
+double * mixed_precision_sequential_solver(linear_system_of_equations lse, int * refinement_steps);
+
+double * mixed_precision_open_mp_solver(linear_system_of_equations lse, int number_of_threads, int * refinement_steps);
+
+long long mixed_precision_bytes_moved(int n, int refinement_steps);
+
+#endif
@@ -3,122 +3,186 @@
 #include <stdint.h>
 #include <fstream>
 #include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+#include <sys/stat.h>
 
 #include <algorithm>
 
 #include <chrono>
 
+#include "solver_library.h"
+#include "reproducible_solver.h"
+
 #define NUM_THREADS 5
 #define READ_CHUNK_SIZE 10
+#define RMA_BLOCK_SIZE 16
+/* The blocks of the fixed order of reproducible_solver.h, so that "grid reproducible" gives the
+ * same bits as the reproducible mode of the shared memory solvers: */
+#define GRID_BLOCK_SIZE REPRODUCIBLE_BLOCK_SIZE
+#define CHECKPOINT_INTERVAL 100
+#define CHECKPOINT_DIRECTORY "checkpoints"
 
 using namespace std;
 
-struct linear_system_of_equations {
-    double **coefficients;
-    double *free_terms;
-    int unknowns_no;
-};
-
 const int NEW_VALUE_FOR_SOLUTION_TAG = 0;
 const int NUMBER_OF_UNKNOWNS_TAG = 1;
+const int GRID_BLOCK_TAG = 2;
 
 /**
- * @brief Read the coefficient matrix from the provided file
- * 
+ * @brief Rank 0 reads the system (with the conventions of TriangularSystem::read) and shares it
+ * with the other ranks, so that every rank holds a copy.
+ *
  * @param coeff_filename The name of the file that stores the coefficient matrix
- * @param unknowns_no The number of unknowns in the equation
- * @return int** the coefficient matrix
+ * @param free_terms_filename The name of the file that stores the free terms
+ * @param unknown_no_filename The name of the file that stores the number of unknowns
+ * @return TriangularSystem The system, on every rank
  */
-double** read_coeff_matrix(char * coeff_filename, int unknowns_no){
-    std::ifstream coeff_file(coeff_filename);
-    // read the number of unknowns:
-    double ** result = new double*[unknowns_no];
-    for(int row_id = 0; row_id < unknowns_no; row_id ++){
-        // read the equations:
-        result[row_id] = new double[unknowns_no];
-        for(int i = 0;i < row_id;i++)result[row_id][i] = 0.0;
-        for(int col_id = row_id; col_id < unknowns_no; col_id++){
-            coeff_file >> result[row_id][col_id];
-            result[row_id][col_id] = result[row_id][col_id]  * 0.01;
-            if(result[row_id][col_id] == 0)result[row_id][col_id] = 1.0;
-        }
+TriangularSystem read_linear_system(const char * coeff_filename, const char * free_terms_filename, const char * unknown_no_filename, int world_rank, int world_size){
+
+    /* The thread with rank 0 will read the linear system of equations and will share the result with the other threads: */
+    int unknowns_no = 0;
+    if(world_rank == 0)unknowns_no = read_unknowns_no(unknown_no_filename);
+    MPI_Bcast(&unknowns_no, 1, MPI_INT, 0, MPI_COMM_WORLD);
+    TriangularSystem result = (world_rank == 0) ? TriangularSystem::read(coeff_filename, free_terms_filename, unknown_no_filename)
+                                                : TriangularSystem(unknowns_no);
+    MPI_Bcast(result.free_terms(), unknowns_no, MPI_DOUBLE, 0, MPI_COMM_WORLD);
+    for(int row_index = 0; row_index < unknowns_no; row_index ++){
+        MPI_Bcast(result.row(row_index), unknowns_no, MPI_DOUBLE, 0, MPI_COMM_WORLD);
     }
-    coeff_file.close();
+
     return result;
 }
 
+
 /**
- * @brief Read the array of free terms from the provided file
- * 
- * @param free_term_filename The filename of the file that stores the free terms
- * @param unknowns_no the number of unknowns in the equation system
- * @return double* The array of free terms
+ * @brief How solution1 checkpoints its progress: every `interval` solved unknowns (0 disables
+ * the checkpoints), into `directory`; with `restart`, the solve resumes from the last complete
+ * checkpoint of that directory.
  */
-double * read_free_terms(char * free_term_filename, int unknowns_no){
-    std::ifstream free_tearm_file(free_term_filename);
-    // read the values:
-    double * result = new double[unknowns_no];
-    for(int eq_id = 0; eq_id < unknowns_no; eq_id ++){
-        free_tearm_file >> result[eq_id];
-        if(result[eq_id] == 0)result[eq_id] = 1000.0;
-    }
-    free_tearm_file.close();
-    return result;
-}
+struct checkpoint_settings {
+    int interval;
+    const char * directory;
+    bool restart;
+};
 
 /**
- * @brief Read the number of unknowns from the provided file
- * 
- * @param filename The name of the file that stores the free terms of the equation system
- * @return int The number of unknowns from the equation system
+ * @brief The checkpoint being written. Two files are used in turn, so that the previous
+ * checkpoint stays valid while the next one is written.
  */
-int read_unknown_no(char * filename){
-    int result = 0;
-    std::ifstream unknowns_no_file(filename);
-    unknowns_no_file >> result;
-    unknowns_no_file.close();
-    return result;
-}
+struct checkpoint_state {
+    MPI_File file;
+    MPI_Request request;
+    double * buffer;
+    int slot;
+    int next_index;
+    bool pending;
+    double time_spent;
+};
 
+void checkpoint_filename(char * filename, const char * directory, int slot){
+    sprintf(filename, "%s/checkpoint_%d.bin", directory, slot);
+}
 
 /**
- * @brief 
- * 
- * @param coeff_filename 
- * @param free_terms_filename 
- * @param no_unknowns 
- * @return linear_system_of_equations 
+ * @brief Wait for the checkpoint in progress, then (rank 0) record it as the latest complete one.
+ * The record is written to a temporary file and renamed, so it is never seen half written.
  */
-linear_system_of_equations read_linear_system(char * coeff_filename, char * free_terms_filename, char * unknown_no_filename, int world_rank, int world_size){
+void finish_checkpoint(checkpoint_state * state, checkpoint_settings settings, int world_rank){
+    if(!state->pending)return;
+    double begin = MPI_Wtime();
+    MPI_Wait(&state->request, MPI_STATUS_IGNORE);
+    /* Closing the file is collective: after it, every rank has written its record. */
+    MPI_File_close(&state->file);
+    if(world_rank == 0){
+        char temporary_filename[1024], latest_filename[1024];
+        sprintf(temporary_filename, "%s/checkpoint_latest.tmp", settings.directory);
+        sprintf(latest_filename, "%s/checkpoint_latest", settings.directory);
+        std::ofstream latest_file(temporary_filename);
+        latest_file << state->slot << " " << state->next_index << "\n";
+        latest_file.close();
+        rename(temporary_filename, latest_filename);
+    }
+    state->pending = false;
+    state->time_spent += MPI_Wtime() - begin;
+}
 
-    linear_system_of_equations result;
+/**
+ * @brief Start an asynchronous checkpoint: every rank copies its progress (the header
+ * n, world_size, next index to solve, then its sum and solution arrays) to a staging buffer and
+ * writes it with MPI_File_iwrite_at at its own offset of the shared file. The solve goes on while
+ * the data is written; the checkpoint is only complete after finish_checkpoint.
+ */
+void start_checkpoint(checkpoint_state * state, checkpoint_settings settings, double * sum, double * solution, int n, int next_index, int world_rank, int world_size){
+    finish_checkpoint(state, settings, world_rank);
+    double begin = MPI_Wtime();
 
-    /* The thread with rank 0 will read the linear system of equations and will share the result with the other threads: */
-    if(world_rank == 0){
-        result.unknowns_no = read_unknown_no(unknown_no_filename);
+    long long record_size = 2 * (long long)n + 3;
+    state->buffer[0] = n;
+    state->buffer[1] = world_size;
+    state->buffer[2] = next_index;
+    for(int i = 0; i < n; i++){
+        state->buffer[3 + i] = sum[i];
+        state->buffer[3 + n + i] = solution[i];
     }
-    MPI_Bcast(&result.unknowns_no, 1, MPI_INT, 0, MPI_COMM_WORLD);
+
+    state->slot = 1 - state->slot;
+    state->next_index = next_index;
+    char filename[1024];
+    checkpoint_filename(filename, settings.directory, state->slot);
+    MPI_File_open(MPI_COMM_WORLD, filename, MPI_MODE_CREATE | MPI_MODE_WRONLY, MPI_INFO_NULL, &state->file);
+    MPI_Offset offset = (MPI_Offset)world_rank * record_size * sizeof(double);
+    MPI_File_iwrite_at(state->file, offset, state->buffer, (int)record_size, MPI_DOUBLE, &state->request);
+    state->pending = true;
+    state->time_spent += MPI_Wtime() - begin;
+}
+
+/**
+ * @brief Load the progress of this rank from the latest complete checkpoint.
+ *
+ * @param slot Output: the slot of the loaded checkpoint, which the next checkpoint must not overwrite
+ * @return int The next index to solve, or -1 if there is no usable checkpoint (then nothing is loaded)
+ */
+int load_checkpoint(checkpoint_settings settings, double * sum, double * solution, int n, int world_rank, int world_size, int * slot){
+    int latest[2] = {-1, -1};
     if(world_rank == 0){
-        result.coefficients = read_coeff_matrix(coeff_filename, result.unknowns_no);
-        result.free_terms = read_free_terms(free_terms_filename, result.unknowns_no);
-    }
-    else{
-        result.coefficients = new double*[result.unknowns_no];
-        result.free_terms = new double[result.unknowns_no];
+        char latest_filename[1024];
+        sprintf(latest_filename, "%s/checkpoint_latest", settings.directory);
+        std::ifstream latest_file(latest_filename);
+        if(!(latest_file >> latest[0] >> latest[1])){
+            latest[0] = -1;
+            latest[1] = -1;
+        }
+        latest_file.close();
     }
-    MPI_Bcast(result.free_terms, result.unknowns_no, MPI_DOUBLE, 0, MPI_COMM_WORLD);
-    for(int row_index = 0; row_index < result.unknowns_no; row_index ++){
-        if(world_rank != 0){
-            result.coefficients[row_index] = new double[result.unknowns_no];
+    MPI_Bcast(latest, 2, MPI_INT, 0, MPI_COMM_WORLD);
+    if(latest[0] < 0)return -1;
+
+    long long record_size = 2 * (long long)n + 3;
+    double * buffer = new double[record_size];
+    char filename[1024];
+    checkpoint_filename(filename, settings.directory, latest[0]);
+    MPI_File file;
+    MPI_File_open(MPI_COMM_WORLD, filename, MPI_MODE_RDONLY, MPI_INFO_NULL, &file);
+    MPI_File_read_at_all(file, (MPI_Offset)world_rank * record_size * sizeof(double), buffer, (int)record_size, MPI_DOUBLE, MPI_STATUS_IGNORE);
+    MPI_File_close(&file);
+
+    /* The checkpoint must come from the same system and the same number of ranks: */
+    int valid = (buffer[0] == n && buffer[1] == world_size && buffer[2] == latest[1]) ? 1 : 0;
+    int all_valid = 0;
+    MPI_Allreduce(&valid, &all_valid, 1, MPI_INT, MPI_MIN, MPI_COMM_WORLD);
+    if(all_valid){
+        for(int i = 0; i < n; i++){
+            sum[i] = buffer[3 + i];
+            solution[i] = buffer[3 + n + i];
         }
-        MPI_Bcast(result.coefficients[row_index], result.unknowns_no, MPI_DOUBLE, 0, MPI_COMM_WORLD);
     }
-
-    return result;
+    delete[] buffer;
+    if(all_valid)*slot = latest[0];
+    return all_valid ? latest[1] : -1;
 }
 
-
-void solution1(linear_system_of_equations lse, double absolute_begin){
+void solution1(linear_system_of_equations lse, double absolute_begin, checkpoint_settings checkpoint){
 
     double begin = MPI_Wtime();
 
@@ -173,7 +237,25 @@ void solution1(linear_system_of_equations lse, double absolute_begin){
         solution[sum_index] = -11111111111111.0000001;
     }
 
-    for(solved_index = tl_lse.unknowns_no - 1; solved_index > -1; solved_index --){
+    checkpoint_state checkpoint_progress;
+    /* The slot of the last checkpoint; the next one goes to the other slot: */
+    checkpoint_progress.slot = 0;
+    checkpoint_progress.pending = false;
+    checkpoint_progress.time_spent = 0.0;
+    checkpoint_progress.buffer = (checkpoint.interval > 0) ? new double[2 * (long long)lse.unknowns_no + 3] : 0;
+
+    int first_index = tl_lse.unknowns_no - 1;
+    if(checkpoint.restart){
+        int resumed_index = load_checkpoint(checkpoint, sum, solution, lse.unknowns_no, world_rank, world_size, &checkpoint_progress.slot);
+        if(resumed_index >= 0)first_index = resumed_index;
+        if(world_rank == 0){
+            if(resumed_index >= 0)printf("restarting from the checkpoint, at unknown %d\n", resumed_index);
+            else printf("no usable checkpoint in %s, starting from the beginning\n", checkpoint.directory);
+        }
+    }
+    int steps_since_checkpoint = 0;
+
+    for(solved_index = first_index; solved_index > -1; solved_index --){
 
         if(solved_index % world_size == world_rank){
             if(tl_lse.coefficients[solved_index][solved_index] == 0)solution[solved_index] = 0.0;
@@ -201,17 +283,460 @@ void solution1(linear_system_of_equations lse, double absolute_begin){
         }
 
         MPI_Barrier(MPI_COMM_WORLD);
+
+        steps_since_checkpoint += 1;
+        if(checkpoint.interval > 0 && steps_since_checkpoint >= checkpoint.interval && solved_index > 0){
+            start_checkpoint(&checkpoint_progress, checkpoint, sum, solution, lse.unknowns_no, solved_index - 1, world_rank, world_size);
+            steps_since_checkpoint = 0;
+        }
     }
+    finish_checkpoint(&checkpoint_progress, checkpoint, world_rank);
+    delete[] checkpoint_progress.buffer;
 
     // if(world_rank == 0)for(int i = 0; i < lse.unknowns_no; i++)printf("%f\n", solution[i]);
 
     double end = MPI_Wtime();
 
+    if(world_rank == 0){
+        printf("execution_elapsed_time: %f\n", end - begin);
+        printf("total elapsed time: %f\n", end - absolute_begin);
+        if(checkpoint.interval > 0)printf("checkpoint time (rank 0): %f\n", checkpoint_progress.time_spent);
+    }
+
+}
+
+/**
+ * @brief The position of the first coefficient (the diagonal one) of a row, inside the packed
+ * upper triangle of an n x n matrix.
+ */
+long long packed_row_offset(int row_id, int n){
+    return (long long)row_id * n - (long long)row_id * (row_id - 1) / 2;
+}
+
+/**
+ * @brief Parse the coefficient and free terms files directly into the packed storage of the
+ * shared window (with the same value conventions as TriangularSystem::read).
+ */
+void read_packed_linear_system(const char * coeff_filename, const char * free_terms_filename, int unknowns_no, double * packed, double * free_terms){
+    std::ifstream coeff_file(coeff_filename);
+    for(int row_id = 0; row_id < unknowns_no; row_id ++){
+        double * row = packed + packed_row_offset(row_id, unknowns_no);
+        for(int col_id = row_id; col_id < unknowns_no; col_id++)row[col_id - row_id] = read_coefficient(coeff_file, READER_CONVENTION);
+    }
+    coeff_file.close();
+    std::ifstream free_tearm_file(free_terms_filename);
+    for(int eq_id = 0; eq_id < unknowns_no; eq_id ++)free_terms[eq_id] = read_free_term(free_tearm_file, READER_CONVENTION);
+    free_tearm_file.close();
+}
+
+/**
+ * @brief Same algorithm as solution1, but the ranks of a node share one copy of the system:
+ * MPI_COMM_WORLD is split by node, and the packed upper triangle lives in a single
+ * MPI_Win_allocate_shared window per node. Only the node leaders exchange data over MPI;
+ * the solved unknowns reach the other ranks of a node through a shared solution window.
+ */
+void solution2(const char * coeff_filename, const char * free_terms_filename, const char * unknown_no_filename, double absolute_begin){
+
+    int world_rank;
+    MPI_Comm_rank(MPI_COMM_WORLD, &world_rank);
+    int world_size;
+    MPI_Comm_size(MPI_COMM_WORLD, &world_size);
+
+    /* The ranks of the same node, and the communicator of the node leaders: */
+    MPI_Comm node_comm;
+    MPI_Comm_split_type(MPI_COMM_WORLD, MPI_COMM_TYPE_SHARED, 0, MPI_INFO_NULL, &node_comm);
+    int node_rank;
+    MPI_Comm_rank(node_comm, &node_rank);
+    MPI_Comm leader_comm;
+    MPI_Comm_split(MPI_COMM_WORLD, node_rank == 0 ? 0 : MPI_UNDEFINED, world_rank, &leader_comm);
+
+    /* Every rank learns the index of its node (its leader's rank in leader_comm), then the node of every rank: */
+    int node_index = 0;
+    if(node_rank == 0)MPI_Comm_rank(leader_comm, &node_index);
+    MPI_Bcast(&node_index, 1, MPI_INT, 0, node_comm);
+    int * node_of_rank = new int[world_size];
+    MPI_Allgather(&node_index, 1, MPI_INT, node_of_rank, 1, MPI_INT, MPI_COMM_WORLD);
+
+    int n = 0;
+    if(world_rank == 0)n = read_unknowns_no(unknown_no_filename);
+    MPI_Bcast(&n, 1, MPI_INT, 0, MPI_COMM_WORLD);
+
+    /* One window per node: the packed matrix, the free terms and the solutions. Only the leader allocates memory: */
+    long long packed_size = (long long)n * (n + 1) / 2;
+    MPI_Aint window_size = (node_rank == 0) ? (MPI_Aint)((packed_size + 2 * (long long)n) * sizeof(double)) : 0;
+    double * window_base;
+    MPI_Win window;
+    MPI_Win_allocate_shared(window_size, sizeof(double), MPI_INFO_NULL, node_comm, &window_base, &window);
+    MPI_Aint queried_size;
+    int displacement_unit;
+    MPI_Win_shared_query(window, 0, &queried_size, &displacement_unit, &window_base);
+    double * packed = window_base;
+    double * free_terms = packed + packed_size;
+    double * shared_solution = free_terms + n;
+    MPI_Win_lock_all(MPI_MODE_NOCHECK, window);
+
+    /* Rank 0 parses the files into its node's window, then the leaders copy it to the other nodes: */
+    if(world_rank == 0)read_packed_linear_system(coeff_filename, free_terms_filename, n, packed, free_terms);
+    if(node_rank == 0){
+        const long long chunk = 1 << 26;
+        for(long long offset = 0; offset < packed_size + n; offset += chunk){
+            int count = (int)((packed_size + n - offset < chunk) ? packed_size + n - offset : chunk);
+            MPI_Bcast(packed + offset, count, MPI_DOUBLE, 0, leader_comm);
+        }
+    }
+    MPI_Win_sync(window);
+    MPI_Barrier(node_comm);
+    MPI_Win_sync(window);
+
+    double begin = MPI_Wtime();
+
+    double * sum = new double[n];
+    for(int sum_index = 0; sum_index < n; sum_index ++)sum[sum_index] = free_terms[sum_index];
+
+    int start_index = 0;
+    for(int solved_index = n - 1; solved_index > -1; solved_index --){
+        int owner = solved_index % world_size;
+        if(world_rank == owner){
+            double diagonal = packed[packed_row_offset(solved_index, n)];
+            if(diagonal == 0)shared_solution[solved_index] = 0.0;
+            else shared_solution[solved_index] = sum[solved_index] / diagonal;
+        }
+        MPI_Win_sync(window);
+        MPI_Barrier(node_comm);
+        MPI_Win_sync(window);
+
+        /* Only the leaders talk over MPI; the leader of the owner's node already sees the value: */
+        if(node_rank == 0){
+            MPI_Bcast(&shared_solution[solved_index], 1, MPI_DOUBLE, node_of_rank[owner], leader_comm);
+            MPI_Win_sync(window);
+        }
+        MPI_Barrier(node_comm);
+        MPI_Win_sync(window);
+
+        double value = shared_solution[solved_index];
+        start_index = solved_index - 1;
+        while(start_index > -1 && start_index % world_size != world_rank)start_index --;
+        for(int future_solution_index = start_index; future_solution_index > -1; future_solution_index -= world_size){
+            sum[future_solution_index] -= value * packed[packed_row_offset(future_solution_index, n) + solved_index - future_solution_index];
+        }
+    }
+
+    double end = MPI_Wtime();
+
+    if(world_rank == 0){
+        printf("execution_elapsed_time: %f\n", end - begin);
+        printf("total elapsed time: %f\n", end - absolute_begin);
+    }
+
+    MPI_Win_unlock_all(window);
+    MPI_Win_free(&window);
+    if(leader_comm != MPI_COMM_NULL)MPI_Comm_free(&leader_comm);
+    MPI_Comm_free(&node_comm);
+    delete[] node_of_rank;
+    delete[] sum;
+}
+
+/**
+ * @brief Same distribution as solution1, but by blocks of RMA_BLOCK_SIZE rows (block b belongs to
+ * rank b % world_size), and without collectives: the owner of a block solves it, then MPI_Puts
+ * the solved values and a notification flag directly into the windows of the other ranks. Every
+ * rank only waits (passive target) for the flag of the block it needs next, so a fast rank never
+ * waits for the slowest one at every step.
+ */
+void solution3(linear_system_of_equations lse, double absolute_begin){
+
+    int world_rank;
+    MPI_Comm_rank(MPI_COMM_WORLD, &world_rank);
+    int world_size;
+    MPI_Comm_size(MPI_COMM_WORLD, &world_size);
+
+    int n = lse.unknowns_no;
+    int blocks_no = (n + RMA_BLOCK_SIZE - 1) / RMA_BLOCK_SIZE;
+
+    /* The solutions and the "block is solved" flags, written remotely by the owners: */
+    double * solution;
+    int * block_ready;
+    MPI_Win solution_window;
+    MPI_Win flag_window;
+    MPI_Win_allocate((MPI_Aint)n * sizeof(double), sizeof(double), MPI_INFO_NULL, MPI_COMM_WORLD, &solution, &solution_window);
+    MPI_Win_allocate((MPI_Aint)blocks_no * sizeof(int), sizeof(int), MPI_INFO_NULL, MPI_COMM_WORLD, &block_ready, &flag_window);
+    for(int block_id = 0; block_id < blocks_no; block_id++)block_ready[block_id] = 0;
+    MPI_Win_lock_all(0, solution_window);
+    MPI_Win_lock_all(0, flag_window);
+    MPI_Barrier(MPI_COMM_WORLD);
+
+    double begin = MPI_Wtime();
+
+    double * sum = new double[n];
+    for(int sum_index = 0; sum_index < n; sum_index ++)sum[sum_index] = lse.free_terms[sum_index];
+    int ready = 1;
+
+    for(int block_id = blocks_no - 1; block_id > -1; block_id--){
+        int first_row = block_id * RMA_BLOCK_SIZE;
+        int last_row = (first_row + RMA_BLOCK_SIZE < n) ? first_row + RMA_BLOCK_SIZE : n;
+
+        if(block_id % world_size == world_rank){
+            /* Solve the block; the sums of its rows already hold the contributions of the later blocks: */
+            for(int row_id = last_row - 1; row_id >= first_row; row_id--){
+                double value = sum[row_id];
+                for(int col_id = row_id + 1; col_id < last_row; col_id++)value -= lse.coefficients[row_id][col_id] * solution[col_id];
+                if(lse.coefficients[row_id][row_id] == 0)solution[row_id] = 0.0;
+                else solution[row_id] = value / lse.coefficients[row_id][row_id];
+            }
+            /* Put the values, make sure they arrived, then raise the flag: */
+            for(int other_rank = 0; other_rank < world_size; other_rank++){
+                if(other_rank == world_rank)continue;
+                MPI_Put(solution + first_row, last_row - first_row, MPI_DOUBLE, other_rank, first_row, last_row - first_row, MPI_DOUBLE, solution_window);
+            }
+            MPI_Win_flush_all(solution_window);
+            for(int other_rank = 0; other_rank < world_size; other_rank++){
+                if(other_rank == world_rank)continue;
+                MPI_Put(&ready, 1, MPI_INT, other_rank, block_id, 1, MPI_INT, flag_window);
+            }
+            MPI_Win_flush_all(flag_window);
+        }
+        else{
+            int message_waiting = 0;
+            while(true){
+                MPI_Win_sync(flag_window);
+                if(((volatile int *)block_ready)[block_id] != 0)break;
+                /* Let the MPI library make progress on the incoming puts: */
+                MPI_Iprobe(MPI_ANY_SOURCE, MPI_ANY_TAG, MPI_COMM_WORLD, &message_waiting, MPI_STATUS_IGNORE);
+            }
+            MPI_Win_sync(solution_window);
+        }
+
+        /* Push the solved block into the sums of the own rows above it: */
+        int start_block = block_id - 1;
+        while(start_block > -1 && start_block % world_size != world_rank)start_block --;
+        for(int own_block = start_block; own_block > -1; own_block -= world_size){
+            int own_last = (own_block + 1) * RMA_BLOCK_SIZE;
+            for(int row_id = own_block * RMA_BLOCK_SIZE; row_id < own_last; row_id++){
+                double * row = lse.coefficients[row_id];
+                for(int col_id = first_row; col_id < last_row; col_id++)sum[row_id] -= row[col_id] * solution[col_id];
+            }
+        }
+    }
+
+    double end = MPI_Wtime();
+
     if(world_rank == 0){
         printf("execution_elapsed_time: %f\n", end - begin);
         printf("total elapsed time: %f\n", end - absolute_begin);
     }
 
+    MPI_Win_unlock_all(flag_window);
+    MPI_Win_unlock_all(solution_window);
+    MPI_Win_free(&flag_window);
+    MPI_Win_free(&solution_window);
+    delete[] sum;
+}
+
+/**
+ * @brief The distributed back-substitution on a P x Q process grid, with the blocks of
+ * GRID_BLOCK_SIZE x GRID_BLOCK_SIZE distributed block-cyclically (ScaLAPACK style): block (I, J)
+ * belongs to the process (I % P, J % Q), which is the only one that stores it. For every block row K:
+ * - the processes of grid row K % P reduce their partial sums of block row K along their row
+ *   communicator, to the owner of the diagonal block;
+ * - the owner solves the diagonal block;
+ * - the solved block is broadcast along grid column K % Q, whose processes add its contribution
+ *   to the partial sums of their block rows above K.
+ * Both the stored blocks and the communication per rank shrink as the grid grows.
+ *
+ * The MPI_Reduce adds the partial sums of the grid columns in an order that depends on the grid
+ * shape. When reproducible is set, the partial sum of every block is kept on its own instead, the
+ * owner of the diagonal block gathers them (MPI_Gatherv) and subtracts them one at a time, last
+ * block first: the fixed order of reproducible_solver.h, for any number of ranks. The other
+ * solutions are already independent of the number of ranks, since every row is only updated by
+ * its owner, in the order the unknowns are solved.
+ */
+void solution4(const char * coeff_filename, const char * free_terms_filename, const char * unknown_no_filename, double absolute_begin, bool reproducible){
+
+    int world_rank;
+    MPI_Comm_rank(MPI_COMM_WORLD, &world_rank);
+    int world_size;
+    MPI_Comm_size(MPI_COMM_WORLD, &world_size);
+
+    /* The process grid and its row / column communicators: */
+    int dims[2] = {0, 0};
+    MPI_Dims_create(world_size, 2, dims);
+    int grid_rows = dims[0];
+    int grid_cols = dims[1];
+    int my_row = world_rank / grid_cols;
+    int my_col = world_rank % grid_cols;
+    MPI_Comm row_comm, col_comm;
+    MPI_Comm_split(MPI_COMM_WORLD, my_row, my_col, &row_comm);
+    MPI_Comm_split(MPI_COMM_WORLD, my_col, my_row, &col_comm);
+
+    int n = 0;
+    if(world_rank == 0)n = read_unknowns_no(unknown_no_filename);
+    MPI_Bcast(&n, 1, MPI_INT, 0, MPI_COMM_WORLD);
+    int blocks_no = (n + GRID_BLOCK_SIZE - 1) / GRID_BLOCK_SIZE;
+
+    double * free_terms = new double[n];
+    TriangularSystem system(0);
+    if(world_rank == 0){
+        system = TriangularSystem::read(coeff_filename, free_terms_filename, unknown_no_filename);
+        for(int i = 0; i < n; i++)free_terms[i] = system.free_terms()[i];
+    }
+    MPI_Bcast(free_terms, n, MPI_DOUBLE, 0, MPI_COMM_WORLD);
+
+    /* Rank 0 sends every upper block to its owner; local_blocks[I * blocks_no + J] is null for the blocks of the other ranks: */
+    double ** local_blocks = new double*[(long long)blocks_no * blocks_no];
+    double * send_buffer = new double[GRID_BLOCK_SIZE * GRID_BLOCK_SIZE];
+    for(int block_row = 0; block_row < blocks_no; block_row++){
+        for(int block_col = 0; block_col < blocks_no; block_col++){
+            double ** slot = local_blocks + (long long)block_row * blocks_no + block_col;
+            *slot = 0;
+            if(block_col < block_row)continue;
+            int owner = (block_row % grid_rows) * grid_cols + block_col % grid_cols;
+            if(world_rank != 0 && world_rank != owner)continue;
+            double * block = (world_rank == owner) ? new double[GRID_BLOCK_SIZE * GRID_BLOCK_SIZE] : send_buffer;
+            if(world_rank == 0){
+                for(int i = 0; i < GRID_BLOCK_SIZE; i++){
+                    for(int j = 0; j < GRID_BLOCK_SIZE; j++){
+                        int row_id = block_row * GRID_BLOCK_SIZE + i;
+                        int col_id = block_col * GRID_BLOCK_SIZE + j;
+                        block[i * GRID_BLOCK_SIZE + j] = (row_id < n && col_id < n) ? system.row(row_id)[col_id] : 0.0;
+                    }
+                }
+                if(owner != 0)MPI_Send(block, GRID_BLOCK_SIZE * GRID_BLOCK_SIZE, MPI_DOUBLE, owner, GRID_BLOCK_TAG, MPI_COMM_WORLD);
+            }
+            else MPI_Recv(block, GRID_BLOCK_SIZE * GRID_BLOCK_SIZE, MPI_DOUBLE, 0, GRID_BLOCK_TAG, MPI_COMM_WORLD, MPI_STATUS_IGNORE);
+            if(world_rank == owner)*slot = block;
+        }
+    }
+    delete[] send_buffer;
+    system = TriangularSystem(0);
+
+    MPI_Barrier(MPI_COMM_WORLD);
+    double begin = MPI_Wtime();
+
+    double * partial_sum = new double[n];
+    double * solution = new double[n];
+    double * reduced = new double[GRID_BLOCK_SIZE];
+    for(int i = 0; i < n; i++){
+        partial_sum[i] = 0.0;
+        solution[i] = 0.0;
+    }
+
+    /* The reproducible mode keeps one partial sum per own off-diagonal block, like local_blocks: */
+    double ** block_partials = 0;
+    double * gather_send = 0;
+    double * gather_receive = 0;
+    int * gather_counts = 0;
+    int * gather_displacements = 0;
+    if(reproducible){
+        block_partials = new double*[(long long)blocks_no * blocks_no];
+        for(long long block_id = 0; block_id < (long long)blocks_no * blocks_no; block_id++){
+            bool off_diagonal = block_id / blocks_no != block_id % blocks_no;
+            block_partials[block_id] = (off_diagonal && local_blocks[block_id] != 0) ? new double[GRID_BLOCK_SIZE] : 0;
+        }
+        gather_send = new double[(long long)blocks_no * GRID_BLOCK_SIZE];
+        gather_receive = new double[(long long)blocks_no * GRID_BLOCK_SIZE];
+        gather_counts = new int[grid_cols];
+        gather_displacements = new int[grid_cols];
+    }
+
+    for(int block_id = blocks_no - 1; block_id > -1; block_id--){
+        int first_row = block_id * GRID_BLOCK_SIZE;
+        int size = (n - first_row < GRID_BLOCK_SIZE) ? n - first_row : GRID_BLOCK_SIZE;
+        int owner_row = block_id % grid_rows;
+        int owner_col = block_id % grid_cols;
+
+        if(my_row == owner_row && reproducible){
+            /* Every grid column sends the partial sums of its blocks of block row K, last block first: */
+            for(int col = 0; col < grid_cols; col++)gather_counts[col] = 0;
+            int send_count = 0;
+            for(int block_col = blocks_no - 1; block_col > block_id; block_col--){
+                gather_counts[block_col % grid_cols] += GRID_BLOCK_SIZE;
+                if(block_col % grid_cols != my_col)continue;
+                double * partial = block_partials[(long long)block_id * blocks_no + block_col];
+                for(int i = 0; i < GRID_BLOCK_SIZE; i++)gather_send[send_count + i] = partial[i];
+                send_count += GRID_BLOCK_SIZE;
+            }
+            gather_displacements[0] = 0;
+            for(int col = 1; col < grid_cols; col++)gather_displacements[col] = gather_displacements[col - 1] + gather_counts[col - 1];
+            MPI_Gatherv(gather_send, send_count, MPI_DOUBLE, gather_receive, gather_counts, gather_displacements, MPI_DOUBLE, owner_col, row_comm);
+            if(my_col == owner_col){
+                double * block = local_blocks[(long long)block_id * blocks_no + block_id];
+                for(int i = size - 1; i > -1; i--){
+                    double value = free_terms[first_row + i];
+                    for(int col = 0; col < grid_cols; col++)gather_counts[col] = 0;
+                    for(int block_col = blocks_no - 1; block_col > block_id; block_col--){
+                        int source = block_col % grid_cols;
+                        value -= gather_receive[gather_displacements[source] + gather_counts[source] + i];
+                        gather_counts[source] += GRID_BLOCK_SIZE;
+                    }
+                    double diagonal_sum = 0.0;
+                    for(int j = i + 1; j < size; j++)diagonal_sum += block[i * GRID_BLOCK_SIZE + j] * solution[first_row + j];
+                    value -= diagonal_sum;
+                    if(block[i * GRID_BLOCK_SIZE + i] == 0)solution[first_row + i] = 0.0;
+                    else solution[first_row + i] = value / block[i * GRID_BLOCK_SIZE + i];
+                }
+            }
+        }
+        else if(my_row == owner_row){
+            MPI_Reduce(partial_sum + first_row, reduced, size, MPI_DOUBLE, MPI_SUM, owner_col, row_comm);
+            if(my_col == owner_col){
+                double * block = local_blocks[(long long)block_id * blocks_no + block_id];
+                for(int i = size - 1; i > -1; i--){
+                    double value = free_terms[first_row + i] - reduced[i];
+                    for(int j = i + 1; j < size; j++)value -= block[i * GRID_BLOCK_SIZE + j] * solution[first_row + j];
+                    if(block[i * GRID_BLOCK_SIZE + i] == 0)solution[first_row + i] = 0.0;
+                    else solution[first_row + i] = value / block[i * GRID_BLOCK_SIZE + i];
+                }
+            }
+        }
+
+        if(my_col == owner_col){
+            MPI_Bcast(solution + first_row, size, MPI_DOUBLE, owner_row, col_comm);
+            /* Add the solved block to the partial sums of the own block rows above it: */
+            for(int block_row = my_row; block_row < block_id; block_row += grid_rows){
+                double * block = local_blocks[(long long)block_row * blocks_no + block_id];
+                for(int i = 0; i < GRID_BLOCK_SIZE; i++){
+                    double value = 0.0;
+                    for(int j = 0; j < size; j++)value += block[i * GRID_BLOCK_SIZE + j] * solution[first_row + j];
+                    if(reproducible)block_partials[(long long)block_row * blocks_no + block_id][i] = value;
+                    else partial_sum[block_row * GRID_BLOCK_SIZE + i] += value;
+                }
+            }
+        }
+    }
+
+    double end = MPI_Wtime();
+
+    /* Only the owners of the diagonal blocks hold the final values; collect them on rank 0: */
+    double * owned_solution = new double[n];
+    for(int block_id = 0; block_id < blocks_no; block_id++){
+        bool owner = (my_row == block_id % grid_rows) && (my_col == block_id % grid_cols);
+        for(int i = block_id * GRID_BLOCK_SIZE; i < n && i < (block_id + 1) * GRID_BLOCK_SIZE; i++)owned_solution[i] = owner ? solution[i] : 0.0;
+    }
+    MPI_Reduce(owned_solution, solution, n, MPI_DOUBLE, MPI_SUM, 0, MPI_COMM_WORLD);
+
+    if(world_rank == 0){
+        printf("process grid: %d x %d%s\n", grid_rows, grid_cols, reproducible ? " (reproducible)" : "");
+        printf("execution_elapsed_time: %f\n", end - begin);
+        printf("total elapsed time: %f\n", end - absolute_begin);
+    }
+
+    for(long long block_id = 0; block_id < (long long)blocks_no * blocks_no; block_id++)delete[] local_blocks[block_id];
+    delete[] local_blocks;
+    if(reproducible){
+        for(long long block_id = 0; block_id < (long long)blocks_no * blocks_no; block_id++)delete[] block_partials[block_id];
+        delete[] block_partials;
+        delete[] gather_send;
+        delete[] gather_receive;
+        delete[] gather_counts;
+        delete[] gather_displacements;
+    }
+    delete[] owned_solution;
+    delete[] partial_sum;
+    delete[] solution;
+    delete[] reduced;
+    delete[] free_terms;
+    MPI_Comm_free(&row_comm);
+    MPI_Comm_free(&col_comm);
 }
 
 int main(int argc,char* argv[]){
@@ -226,13 +751,66 @@ int main(int argc,char* argv[]){
     MPI_Comm_size(MPI_COMM_WORLD, &world_size);
 
 
-    char * matrix_coeff_filename = "a_input_1000.txt";
-    char * free_terms_filename = "free_terms_1000.txt";
-    char * unknown_num_filename = "unknown_no_1000.txt";
+    const char * matrix_coeff_filename = "a_input_1000.txt";
+    const char * free_terms_filename = "free_terms_1000.txt";
+    const char * unknown_num_filename = "unknown_no_1000.txt";
+
+    /* "-input coeff_file free_terms_file unknown_no_file", after the mode (or alone), solves another system: */
+    for(int arg_id = 1; arg_id + 3 < argc; arg_id++){
+        if(strcmp(argv[arg_id], "-input") != 0)continue;
+        matrix_coeff_filename = argv[arg_id + 1];
+        free_terms_filename = argv[arg_id + 2];
+        unknown_num_filename = argv[arg_id + 3];
+        argc = arg_id;
+        break;
+    }
 
-    linear_system_of_equations lse = read_linear_system(matrix_coeff_filename, free_terms_filename, unknown_num_filename, world_rank, world_size);
+    checkpoint_settings no_checkpoint;
+    no_checkpoint.interval = 0;
+    no_checkpoint.directory = 0;
+    no_checkpoint.restart = false;
 
-    solution1(lse, absolute_begin);
+    /* "shared": one copy of the system per node (solution2); otherwise, one copy per rank (solution1): */
+    if(argc > 1 && strcmp(argv[1], "shared") == 0){
+        solution2(matrix_coeff_filename, free_terms_filename, unknown_num_filename, absolute_begin);
+    }
+    else if(argc > 1 && strcmp(argv[1], "grid") == 0){
+        /* "grid reproducible": the same bits for any number of ranks: */
+        bool reproducible = argc > 2 && strcmp(argv[2], "reproducible") == 0;
+        solution4(matrix_coeff_filename, free_terms_filename, unknown_num_filename, absolute_begin, reproducible);
+    }
+    else if(argc > 1 && strcmp(argv[1], "rma") == 0){
+        TriangularSystem system = read_linear_system(matrix_coeff_filename, free_terms_filename, unknown_num_filename, world_rank, world_size);
+        linear_system_of_equations lse = system.view();
+        solution3(lse, absolute_begin);
+    }
+    else if(argc > 1 && strcmp(argv[1], "compare") == 0){
+        /* Two-sided (solution1) against one-sided (solution3), on the same system: */
+        TriangularSystem system = read_linear_system(matrix_coeff_filename, free_terms_filename, unknown_num_filename, world_rank, world_size);
+        linear_system_of_equations lse = system.view();
+        if(world_rank == 0)printf("two-sided (MPI_Bcast + MPI_Barrier), %d ranks:\n", world_size);
+        solution1(lse, MPI_Wtime(), no_checkpoint);
+        MPI_Barrier(MPI_COMM_WORLD);
+        if(world_rank == 0)printf("one-sided (MPI_Put + flags), %d ranks:\n", world_size);
+        solution3(lse, MPI_Wtime());
+    }
+    else if(argc > 1 && (strcmp(argv[1], "checkpoint") == 0 || strcmp(argv[1], "restart") == 0)){
+        /* Checkpoint every CHECKPOINT_INTERVAL unknowns (or argv[2]) into CHECKPOINT_DIRECTORY: */
+        checkpoint_settings checkpoint;
+        checkpoint.interval = (argc > 2) ? atoi(argv[2]) : CHECKPOINT_INTERVAL;
+        checkpoint.directory = CHECKPOINT_DIRECTORY;
+        checkpoint.restart = strcmp(argv[1], "restart") == 0;
+        if(world_rank == 0)mkdir(checkpoint.directory, 0755);
+        MPI_Barrier(MPI_COMM_WORLD);
+        TriangularSystem system = read_linear_system(matrix_coeff_filename, free_terms_filename, unknown_num_filename, world_rank, world_size);
+        linear_system_of_equations lse = system.view();
+        solution1(lse, absolute_begin, checkpoint);
+    }
+    else{
+        TriangularSystem system = read_linear_system(matrix_coeff_filename, free_terms_filename, unknown_num_filename, world_rank, world_size);
+        linear_system_of_equations lse = system.view();
+        solution1(lse, absolute_begin, no_checkpoint);
+    }
 
     MPI_Finalize();
 
@@ -1,20 +1,39 @@
 #include "open_mp_solver.h"
 
+/**
+ * @brief Solve the system with OpenMP: a single thread computes every unknown, then the
+ * partial sums of the equations above it are updated by all the threads (the same scheme as
+ * open_mp_assignment.cpp, but with one parallel region for the whole solve).
+ *
+ * @param lse The linear system of equations
+ * @param number_of_threads The number of OpenMP threads
+ * @return double* The solution of the system
+ */
 double * open_mp_parallel_solver(linear_system_of_equations lse, int number_of_threads){
-    
-    bool is_done[lse.unknowns_no];
-    for(int i = 0; i < lse.unknowns_no; i++){
-        is_done[i] = false;
-    }
 
-    double solution[lse.unknowns_no];
+    int n = lse.unknowns_no;
+    double * solution = new double[n];
+    double * sum = new double[n];
+    for(int i = 0; i < n; i++){
+        sum[i] = lse.free_terms[i];
+    }
 
-    #pragma omp parallel for schedule(static, 1)
+    #pragma omp parallel default(none) shared(lse, solution, sum, n) num_threads(number_of_threads)
     {
-        int tid = omp_get_thread_num();
-        for(int equation_index = 0; equation_index < lse.unknowns_no; equation_index++){
-            printf("Hello world %d %d\n", tid, equation_index);
+        for(int solved_index = n - 1; solved_index > -1; solved_index--){
+            #pragma omp single
+            {
+                if(lse.coefficients[solved_index][solved_index] != 0)
+                    solution[solved_index] = sum[solved_index] / lse.coefficients[solved_index][solved_index];
+                else solution[solved_index] = 0;
+            }
+
+            #pragma omp for schedule(static)
+            for(int sum_index = 0; sum_index < solved_index; sum_index++)
+                sum[sum_index] -= lse.coefficients[sum_index][solved_index] * solution[solved_index];
         }
     }
 
-}
\ No newline at end of file
+    delete[] sum;
+    return solution;
+}
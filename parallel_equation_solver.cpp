@@ -1,57 +1,66 @@
 #include <thread>
 #include "parallel_equation_solver.h"
-#include <stdio.h>
-#include <string.h>
-#include <vector>
-
-void manager_thread(int thread_index, linear_system_of_equations lse, double * solution, int number_of_threads, int * needed_counter){
-
-    int number_sums = lse.unknowns_no / number_of_threads;
-    if(thread_index < lse.unknowns_no % number_of_threads) number_sums += 1;
+#include <sched.h>
 
-    // bool * has_been_checked = new bool[lse.unknowns_no];
-    // for(int i = 0; i < lse.unknowns_no; i++)has_been_checked[i] = false;
+#include <atomic>
+#include <vector>
 
-    int managed_sums_count = 0;
-    // do {
-    //     for(int sum_index = lse.unknowns_no - 1; sum_index > -1; sum_index--){
-    //         if(!has_been_checked[sum_index] && needed_counter[sum_index] + sum_index == lse.unknowns_no - 1){
-    //             for(int local_sum_index = thread_index; local_sum_index < lse.unknowns_no; local_sum_index += number_of_threads){
-    //                 if(sum_index > local_sum_index){
-    //                     solution[local_sum_index] -= solution[sum_index] * lse.coefficients[local_sum_index][sum_index] / lse.coefficients[local_sum_index][local_sum_index];
-    //                     needed_counter[local_sum_index] += 1;
-    //                     if(needed_counter[local_sum_index] + local_sum_index == lse.unknowns_no - 1){
-    //                         managed_sums_count += 1;
-    //                         std::printf("sum %d completed\n", local_sum_index);
-    //                     }
-    //                 }
-    //             }
-    //             has_been_checked[sum_index] = true;
-    //         }
-    //     }
-    // } while(managed_sums_count != number_sums);
+/**
+ * @brief The work of one thread: it owns the rows row_id % number_of_threads == thread_index.
+ * For every unknown, from the last one, the owner of its row solves it and publishes it through
+ * solved; the other threads wait for it, then every thread subtracts it from the sums of its own
+ * rows. A row is only written by its owner, so the flag is the only synchronisation.
+ */
+void manager_thread(int thread_index, linear_system_of_equations lse, double * solution, double * sum, int number_of_threads, std::atomic<int> * solved){
+    int n = lse.unknowns_no;
+    for(int solved_index = n - 1; solved_index > -1; solved_index--){
+        int step = n - solved_index;
+        if(solved_index % number_of_threads == thread_index){
+            if(lse.coefficients[solved_index][solved_index] != 0)
+                solution[solved_index] = sum[solved_index] / lse.coefficients[solved_index][solved_index];
+            else solution[solved_index] = 0;
+            solved->store(step, std::memory_order_release);
+        }
+        else{
+            int polls = 0;
+            while(solved->load(std::memory_order_acquire) < step){
+                if(++polls == THREADS_SPIN_BEFORE_YIELD){
+                    polls = 0;
+                    sched_yield();
+                }
+            }
+        }
 
-    for(int i = 0; i < lse.unknowns_no; i++){
-        std::printf("thread %d, needed_counter[%d] = %d\n", thread_index, i, needed_counter[i]);
+        int start_index = solved_index - 1;
+        while(start_index > -1 && start_index % number_of_threads != thread_index)start_index--;
+        for(int row_id = start_index; row_id > -1; row_id -= number_of_threads)
+            sum[row_id] -= lse.coefficients[row_id][solved_index] * solution[solved_index];
     }
-
 }
 
+/**
+ * @brief The column-oriented solver of threads_assignment on std::thread: the threads are created
+ * once per solve (not once per unknown) and own the rows cyclically. Every row subtracts the
+ * unknowns in the same order for any number of threads, so the result does not depend on it.
+ *
+ * @param lse The linear system of equations
+ * @param number_of_threads The number of threads
+ * @return double* The solution of the system
+ */
 double * parallel_system_solver(linear_system_of_equations lse, int number_of_threads){
-    double * solution = new double[lse.unknowns_no];
-    bool * is_finished = new bool[lse.unknowns_no];
-    int * needed_counter = new int[lse.unknowns_no];
-    for(int i = 0; i < lse.unknowns_no - 1; i++){
-        is_finished[i] = false;
-    }
-    solution[lse.unknowns_no - 1] = lse.free_terms[lse.unknowns_no - 1] / lse.coefficients[lse.unknowns_no - 1][lse.unknowns_no - 1];
-    is_finished[lse.unknowns_no - 1] = true;
-    needed_counter[lse.unknowns_no - 1] = 0;
-    std::vector<std::thread> threads; 
-    for(int i = lse.unknowns_no - 2; i > -1; i--){
-        auto th = std::thread(&manager_thread, i, lse, std::ref(solution), number_of_threads, std::ref(needed_counter));
-        th.join();
-    }
+    int n = lse.unknowns_no;
+    if(number_of_threads < 1)number_of_threads = 1;
+    double * solution = new double[n];
+    double * sum = new double[n];
+    for(int row_id = 0; row_id < n; row_id++)sum[row_id] = lse.free_terms[row_id];
+    std::atomic<int> solved(0);
 
+    std::vector<std::thread> threads;
+    for(int thread_index = 1; thread_index < number_of_threads; thread_index++)
+        threads.push_back(std::thread(manager_thread, thread_index, lse, solution, sum, number_of_threads, &solved));
+    manager_thread(0, lse, solution, sum, number_of_threads, &solved);
+    for(size_t thread_id = 0; thread_id < threads.size(); thread_id++)threads[thread_id].join();
+
+    delete[] sum;
     return solution;
-}
\ No newline at end of file
+}
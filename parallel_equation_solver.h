@@ -1,4 +1,11 @@
 #include "linear_system_schema.h"
 
+#ifndef PARALLEL_EQUATION_SOLVER_H
+#define PARALLEL_EQUATION_SOLVER_H
+
+/* A thread waiting for an unknown gives its core away after this many polls: */
+#define THREADS_SPIN_BEFORE_YIELD 1000
+
 double * parallel_system_solver(linear_system_of_equations lse, int number_of_threads);
 
+#endif
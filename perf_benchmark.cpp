@@ -0,0 +1,83 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+
+#include <chrono>
+#include <vector>
+
+#include "solver_library.h"
+#include "perf_counters.h"
+#include "mixed_precision_solver.h"
+
+#define NUM_THREADS 40
+
+double elapsed_seconds(std::chrono::high_resolution_clock::time_point begin){
+    std::chrono::high_resolution_clock::time_point end = std::chrono::high_resolution_clock::now();
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(end - begin).count() * 1e-9;
+}
+
+/**
+ * @brief The verify phase: the relative residual of the solution, computed in parallel.
+ */
+double relative_residual(const TriangularSystem & system, const std::vector<double> & solution){
+    int n = system.unknowns_no();
+    double residual_norm = 0.0;
+    double free_terms_norm = 0.0;
+    #pragma omp parallel for schedule(dynamic, 16) reduction(max:residual_norm, free_terms_norm) num_threads(NUM_THREADS)
+    for(int row_id = 0; row_id < n; row_id++){
+        double * row = system.row(row_id);
+        double value = system.free_terms()[row_id];
+        for(int col_id = row_id; col_id < n; col_id++)value -= row[col_id] * solution[col_id];
+        if(fabs(value) > residual_norm)residual_norm = fabs(value);
+        if(fabs(system.free_terms()[row_id]) > free_terms_norm)free_terms_norm = fabs(system.free_terms()[row_id]);
+    }
+    return residual_norm / free_terms_norm;
+}
+
+int main(){
+
+    const char * matrix_coeff_filename = "a_input_1000.txt";
+    const char * free_terms_filename = "free_terms_1000.txt";
+    const char * unknown_num_filename = "unknown_no_1000.txt";
+
+    /* Opened before the first parallel region, so that every thread of the solvers is counted: */
+    perf_process_counters counters = open_perf_counters();
+    double peak_bandwidth = measure_peak_bandwidth(NUM_THREADS);
+
+    std::chrono::high_resolution_clock::time_point begin = std::chrono::high_resolution_clock::now();
+    start_perf_phase(counters);
+    TriangularSystem system = TriangularSystem::read(matrix_coeff_filename, free_terms_filename, unknown_num_filename);
+    print_perf_phase("load", stop_perf_phase(counters, elapsed_seconds(begin)), 0.0, peak_bandwidth);
+
+    int n = system.unknowns_no();
+    /* The back-substitution: one multiplication and one subtraction per coefficient of the triangle: */
+    double solve_flops = (double)n * n;
+
+    const char * backend_names[] = {"sequential", "open_mp", "recursive", "block_inverse", "mixed_precision", "compensated",
+                                    "row_pull", "hybrid_push", "hybrid_pull", "threads"};
+    solver_backend backends[] = {SEQUENTIAL_BACKEND, OPEN_MP_BACKEND, RECURSIVE_BACKEND, BLOCK_INVERSE_BACKEND, MIXED_PRECISION_BACKEND, COMPENSATED_BACKEND,
+                                 ROW_PULL_BACKEND, HYBRID_PUSH_BACKEND, HYBRID_PULL_BACKEND, THREADS_BACKEND};
+    for(int backend_id = 0; backend_id < 10; backend_id++){
+        std::unique_ptr<Solver> solver = make_solver(backends[backend_id], NUM_THREADS);
+        printf("\n=== %s, n = %d, threads = %d ===\n", backend_names[backend_id], n, NUM_THREADS);
+
+        begin = std::chrono::high_resolution_clock::now();
+        start_perf_phase(counters);
+        std::vector<double> solution = solver->solve(system);
+        print_perf_phase("solve", stop_perf_phase(counters, elapsed_seconds(begin)), solve_flops, peak_bandwidth);
+
+        begin = std::chrono::high_resolution_clock::now();
+        start_perf_phase(counters);
+        double residual = relative_residual(system, solution);
+        print_perf_phase("verify", stop_perf_phase(counters, elapsed_seconds(begin)), solve_flops, peak_bandwidth);
+        printf("relative residual = %e\n", residual);
+    }
+
+    int refinement_steps = 0;
+    delete[] mixed_precision_open_mp_solver(system.view(), NUM_THREADS, &refinement_steps);
+    printf("\nmixed_precision: %d refinement step(s), %lld bytes of matrix moved (a double solve moves %lld)\n",
+           refinement_steps, mixed_precision_bytes_moved(n, refinement_steps), (long long)n * (n + 1) / 2 * (long long)sizeof(double));
+
+    close_perf_counters(counters);
+    return 0;
+}
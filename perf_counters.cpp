@@ -0,0 +1,173 @@
+#include "perf_counters.h"
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <string.h>
+#include <stdio.h>
+
+#include <chrono>
+
+/* The size of each of the STREAM arrays; large enough to not fit in the caches: */
+#define STREAM_ARRAY_SIZE (1 << 24)
+
+/**
+ * @brief Open one counter for the calling thread and the threads it creates from now on
+ * (user space only, any CPU).
+ *
+ * @return int The file descriptor, or -1 if the counter is not available
+ */
+int open_inherited_counter(perf_counter_id counter){
+    struct perf_event_attr attributes;
+    memset(&attributes, 0, sizeof(attributes));
+    attributes.size = sizeof(attributes);
+    attributes.disabled = 1;
+    attributes.inherit = 1;
+    attributes.exclude_kernel = 1;
+    attributes.exclude_hv = 1;
+    if(counter == LLC_MISSES_COUNTER){
+        attributes.type = PERF_TYPE_HW_CACHE;
+        attributes.config = PERF_COUNT_HW_CACHE_LL | (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+    }
+    else{
+        attributes.type = PERF_TYPE_HARDWARE;
+        if(counter == CYCLES_COUNTER)attributes.config = PERF_COUNT_HW_CPU_CYCLES;
+        else if(counter == INSTRUCTIONS_COUNTER)attributes.config = PERF_COUNT_HW_INSTRUCTIONS;
+        else attributes.config = PERF_COUNT_HW_BRANCH_MISSES;
+    }
+    return (int)syscall(__NR_perf_event_open, &attributes, 0, -1, -1, 0);
+}
+
+/**
+ * @brief The number of threads of the process (1 if /proc cannot be read).
+ */
+int count_process_threads(){
+    int threads_no = 1;
+    FILE * status = fopen("/proc/self/status", "r");
+    if(status == NULL)return threads_no;
+    char line[256];
+    while(fgets(line, sizeof(line), status) != NULL){
+        if(sscanf(line, "Threads: %d", &threads_no) == 1)break;
+    }
+    fclose(status);
+    return threads_no;
+}
+
+/**
+ * @brief Open the counters of the process. Call it before the first parallel region (and before
+ * any std::thread is started): the threads that already exist are not counted.
+ *
+ * @return perf_process_counters The counters, disabled
+ */
+perf_process_counters open_perf_counters(){
+    perf_process_counters counters;
+    counters.untracked_threads = count_process_threads() - 1;
+    for(int counter = 0; counter < PERF_COUNTERS_NO; counter++)
+        counters.file_descriptors[counter] = open_inherited_counter((perf_counter_id)counter);
+    return counters;
+}
+
+/* The ioctls of an inherited counter also apply to its copies in the child threads: */
+void start_perf_phase(perf_process_counters counters){
+    for(int counter = 0; counter < PERF_COUNTERS_NO; counter++){
+        if(counters.file_descriptors[counter] < 0)continue;
+        ioctl(counters.file_descriptors[counter], PERF_EVENT_IOC_RESET, 0);
+        ioctl(counters.file_descriptors[counter], PERF_EVENT_IOC_ENABLE, 0);
+    }
+}
+
+/**
+ * @brief Stop the counters; reading an inherited counter sums it over the measured threads.
+ *
+ * @param counters The counters of the process
+ * @param seconds The wall time of the phase
+ * @return perf_phase_result The counters of the phase
+ */
+perf_phase_result stop_perf_phase(perf_process_counters counters, double seconds){
+    perf_phase_result result;
+    result.seconds = seconds;
+    result.untracked_threads = counters.untracked_threads;
+    for(int counter = 0; counter < PERF_COUNTERS_NO; counter++){
+        result.values[counter] = 0;
+        result.available[counter] = false;
+        int file_descriptor = counters.file_descriptors[counter];
+        if(file_descriptor < 0)continue;
+        ioctl(file_descriptor, PERF_EVENT_IOC_DISABLE, 0);
+        long long value = 0;
+        if(read(file_descriptor, &value, sizeof(value)) == sizeof(value)){
+            result.values[counter] = value;
+            result.available[counter] = true;
+        }
+    }
+    return result;
+}
+
+void close_perf_counters(perf_process_counters counters){
+    for(int counter = 0; counter < PERF_COUNTERS_NO; counter++){
+        if(counters.file_descriptors[counter] >= 0)close(counters.file_descriptors[counter]);
+    }
+}
+
+/**
+ * @brief A STREAM-like triad (a = b + s * c) to measure the memory bandwidth of the machine.
+ *
+ * @param number_of_threads The number of OpenMP threads
+ * @return double The best bandwidth out of a few runs, in bytes per second
+ */
+double measure_peak_bandwidth(int number_of_threads){
+    double * a = new double[STREAM_ARRAY_SIZE];
+    double * b = new double[STREAM_ARRAY_SIZE];
+    double * c = new double[STREAM_ARRAY_SIZE];
+    #pragma omp parallel for schedule(static) num_threads(number_of_threads)
+    for(int i = 0; i < STREAM_ARRAY_SIZE; i++){
+        a[i] = 0.0;
+        b[i] = 1.0;
+        c[i] = 2.0;
+    }
+
+    double best_seconds = 1e30;
+    for(int run = 0; run < 5; run++){
+        std::chrono::high_resolution_clock::time_point begin = std::chrono::high_resolution_clock::now();
+        #pragma omp parallel for schedule(static) num_threads(number_of_threads)
+        for(int i = 0; i < STREAM_ARRAY_SIZE; i++)a[i] = b[i] + 3.0 * c[i];
+        std::chrono::high_resolution_clock::time_point end = std::chrono::high_resolution_clock::now();
+        double seconds = std::chrono::duration_cast<std::chrono::nanoseconds>(end - begin).count() * 1e-9;
+        if(seconds < best_seconds)best_seconds = seconds;
+    }
+
+    delete[] a;
+    delete[] b;
+    delete[] c;
+    return 3.0 * sizeof(double) * STREAM_ARRAY_SIZE / best_seconds;
+}
+
+/**
+ * @brief Print the counters of a phase and the derived metrics: IPC, DRAM bytes (LLC misses times
+ * the line size) per FLOP, and the achieved bandwidth against the measured peak.
+ *
+ * @param phase_name The name of the phase
+ * @param result The counters of the phase
+ * @param flops The number of floating point operations of the phase (0 if not meaningful)
+ * @param peak_bandwidth The result of measure_peak_bandwidth, in bytes per second
+ */
+void print_perf_phase(const char * phase_name, perf_phase_result result, double flops, double peak_bandwidth){
+    const char * counter_names[PERF_COUNTERS_NO] = {"cycles", "instructions", "llc_misses", "branch_misses"};
+    printf("%s: %.6f s\n", phase_name, result.seconds);
+    if(result.untracked_threads > 0)
+        printf("    measured       the opening thread and the threads started after it (%d older threads are not counted)\n", result.untracked_threads);
+    else printf("    measured       every thread of the process\n");
+    for(int counter = 0; counter < PERF_COUNTERS_NO; counter++){
+        if(result.available[counter])printf("    %-14s %lld\n", counter_names[counter], result.values[counter]);
+        else printf("    %-14s n/a\n", counter_names[counter]);
+    }
+    if(result.available[CYCLES_COUNTER] && result.available[INSTRUCTIONS_COUNTER] && result.values[CYCLES_COUNTER] > 0)
+        printf("    IPC            %.3f\n", (double)result.values[INSTRUCTIONS_COUNTER] / result.values[CYCLES_COUNTER]);
+    if(result.available[LLC_MISSES_COUNTER] && result.seconds > 0){
+        double bytes = (double)result.values[LLC_MISSES_COUNTER] * CACHE_LINE_BYTES;
+        double bandwidth = bytes / result.seconds;
+        if(flops > 0)printf("    bytes/FLOP     %.3f\n", bytes / flops);
+        printf("    bandwidth      %.3f GB/s (%.1f%% of the %.3f GB/s peak)\n", bandwidth * 1e-9, 100.0 * bandwidth / peak_bandwidth, peak_bandwidth * 1e-9);
+        if(bandwidth >= BANDWIDTH_BOUND_FRACTION * peak_bandwidth)printf("    -> bandwidth-bound\n");
+        else printf("    -> not bandwidth-bound (latency or synchronization)\n");
+    }
+}
@@ -0,0 +1,51 @@
+#ifndef PERF_COUNTERS_H
+#define PERF_COUNTERS_H
+
+/* The size of a cache line, used to turn LLC misses into DRAM bytes: */
+#define CACHE_LINE_BYTES 64
+/* Above this fraction of the measured peak, a phase is reported as bandwidth-bound: */
+#define BANDWIDTH_BOUND_FRACTION 0.7
+
+enum perf_counter_id {
+    CYCLES_COUNTER,
+    INSTRUCTIONS_COUNTER,
+    LLC_MISSES_COUNTER,
+    BRANCH_MISSES_COUNTER,
+    PERF_COUNTERS_NO
+};
+
+/**
+ * @brief The hardware counters of the process. They are opened by one thread with inherit set, so
+ * they count that thread and every thread it (or its children) creates afterwards: the OpenMP
+ * teams, the std::thread workers and the threads of the solver pools, including the ones that
+ * have exited. The threads that already existed when the counters were opened are not counted;
+ * untracked_threads is their number. A file descriptor of -1 means the counter is not available.
+ */
+struct perf_process_counters {
+    int file_descriptors[PERF_COUNTERS_NO];
+    int untracked_threads;
+};
+
+/**
+ * @brief The counters of one phase, summed over the measured threads.
+ */
+struct perf_phase_result {
+    long long values[PERF_COUNTERS_NO];
+    bool available[PERF_COUNTERS_NO];
+    double seconds;
+    int untracked_threads;
+};
+
+perf_process_counters open_perf_counters();
+
+void start_perf_phase(perf_process_counters counters);
+
+perf_phase_result stop_perf_phase(perf_process_counters counters, double seconds);
+
+void close_perf_counters(perf_process_counters counters);
+
+double measure_peak_bandwidth(int number_of_threads);
+
+void print_perf_phase(const char * phase_name, perf_phase_result result, double flops, double peak_bandwidth);
+
+#endif
@@ -0,0 +1,93 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+
+#include <chrono>
+#include <vector>
+
+#include "linear_system_schema.h"
+#include "pipelined_solver.h"
+#include "solver_library.h"
+
+#define NUM_THREADS 40
+#define PIPELINED_SEED 1
+#define GENERATOR_COMMAND "./system_generator.exe"
+
+double elapsed_seconds(std::chrono::high_resolution_clock::time_point begin){
+    return std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - begin).count();
+}
+
+/**
+ * @brief Write a system of n unknowns with the generator, in the given layout (bottom_up or binary).
+ */
+bool generate_bottom_up_system(int n, const char * layout, const char * coeff_filename, const char * free_terms_filename, const char * unknown_no_filename){
+    char command[512];
+    int length = snprintf(command, sizeof(command), "%s %d %u %s %s %s %s", GENERATOR_COMMAND, n, (unsigned int)PIPELINED_SEED,
+                          coeff_filename, free_terms_filename, unknown_no_filename, layout);
+    if(length < 0 || length >= (int)sizeof(command) || system(command) != 0){
+        printf("could not generate a system of %d unknowns with %s\n", n, GENERATOR_COMMAND);
+        return false;
+    }
+    return true;
+}
+
+/**
+ * @brief Time the load alone, the solve alone and the pipelined load and solve of one file.
+ */
+void run_benchmark(int n, coefficient_file_format format, int number_of_threads){
+    const char * layout = (format == BINARY_COEFFICIENTS) ? "binary" : "bottom_up";
+    const char * coeff_filename = (format == BINARY_COEFFICIENTS) ? "pipelined_input.bin" : "pipelined_input.txt";
+    const char * free_terms_filename = "pipelined_free_terms.txt";
+    const char * unknown_no_filename = "pipelined_unknown_no.txt";
+    if(!generate_bottom_up_system(n, layout, coeff_filename, free_terms_filename, unknown_no_filename))return;
+
+    auto begin = std::chrono::high_resolution_clock::now();
+    TriangularSystem system = read_bottom_up_system(coeff_filename, free_terms_filename, unknown_no_filename, format);
+    double load_seconds = elapsed_seconds(begin);
+    if(system.unknowns_no() != n)return;
+
+    std::unique_ptr<Solver> solver = make_solver(OPEN_MP_BACKEND, number_of_threads);
+    begin = std::chrono::high_resolution_clock::now();
+    std::vector<double> reference = solver->solve(system);
+    double solve_seconds = elapsed_seconds(begin);
+
+    begin = std::chrono::high_resolution_clock::now();
+    double * solution = pipelined_load_and_solve(coeff_filename, free_terms_filename, unknown_no_filename, format, number_of_threads);
+    double overlapped_seconds = elapsed_seconds(begin);
+    if(solution == NULL)return;
+
+    /* The generated systems are not diagonally dominant, so the last unknowns overflow for large n: */
+    double difference = 0.0, magnitude = 0.0;
+    int finite_no = 0;
+    for(int i = 0; i < n; i++){
+        if(!isfinite(reference[i]))continue;
+        difference = fmax(difference, fabs(solution[i] - reference[i]));
+        magnitude = fmax(magnitude, fabs(reference[i]));
+        finite_no += 1;
+    }
+    printf("%s file (n = %d): load only %f s, solve only %f s, load then solve %f s, overlapped %f s\n",
+           layout, n, load_seconds, solve_seconds, load_seconds + solve_seconds, overlapped_seconds);
+    printf("    max relative difference = %e (over the %d finite unknowns)\n", (magnitude > 0) ? difference / magnitude : 0.0, finite_no);
+
+    delete[] solution;
+    remove(coeff_filename);
+    remove(free_terms_filename);
+    remove(unknown_no_filename);
+}
+
+/**
+ * @brief Usage: pipelined_benchmark [n] [threads]
+ * Generates the system bottom-up, as text and as raw doubles, and compares loading then solving
+ * it with the pipelined load and solve.
+ */
+int main(int argc, char ** argv){
+    int n = (argc > 1) ? atoi(argv[1]) : 4000;
+    int number_of_threads = (argc > 2) ? atoi(argv[2]) : NUM_THREADS;
+    if(n < 1 || number_of_threads < 1){
+        printf("invalid arguments: %d unknowns, %d threads\n", n, number_of_threads);
+        return 1;
+    }
+    run_benchmark(n, TEXT_COEFFICIENTS, number_of_threads);
+    run_benchmark(n, BINARY_COEFFICIENTS, number_of_threads);
+    return 0;
+}
@@ -0,0 +1,211 @@
+#include "pipelined_solver.h"
+#include <stdio.h>
+#include <fstream>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+
+/**
+ * @brief A bounded FIFO of rows, between the reader thread and the solver.
+ */
+struct bounded_row_queue {
+    double *rows[PIPELINE_QUEUE_CAPACITY];
+    int head;
+    int size;
+    std::mutex lock;
+    std::condition_variable not_empty;
+    std::condition_variable not_full;
+};
+
+void push_row(bounded_row_queue * queue, double * row){
+    std::unique_lock<std::mutex> guard(queue->lock);
+    while(queue->size == PIPELINE_QUEUE_CAPACITY)queue->not_full.wait(guard);
+    queue->rows[(queue->head + queue->size) % PIPELINE_QUEUE_CAPACITY] = row;
+    queue->size += 1;
+    queue->not_empty.notify_one();
+}
+
+double * pop_row(bounded_row_queue * queue){
+    std::unique_lock<std::mutex> guard(queue->lock);
+    while(queue->size == 0)queue->not_empty.wait(guard);
+    double * row = queue->rows[queue->head];
+    queue->head = (queue->head + 1) % PIPELINE_QUEUE_CAPACITY;
+    queue->size -= 1;
+    queue->not_full.notify_one();
+    return row;
+}
+
+/**
+ * @brief Read the next row of a bottom-up coefficient file: the length coefficients of the row,
+ * starting with the diagonal, as text or raw doubles, with the value convention of the text
+ * readers (see read_coefficient). Returns false if the row cannot be read.
+ */
+bool read_bottom_up_row(std::ifstream & coeff_file, coefficient_file_format format, coefficient_convention convention, double * row, int length){
+    if(format == BINARY_COEFFICIENTS){
+        coeff_file.read((char *)row, sizeof(double) * length);
+        for(int i = 0; i < length; i++)row[i] = convert_coefficient(row[i], convention);
+    }
+    else for(int i = 0; i < length && coeff_file; i++)row[i] = read_coefficient(coeff_file, convention);
+    return (bool)coeff_file;
+}
+
+/**
+ * @brief Read the number of unknowns and the free terms of a system (n = 0 if they cannot be read).
+ */
+double * read_pipeline_free_terms(const char * free_terms_filename, const char * unknown_no_filename, coefficient_convention convention, int & n){
+    n = read_unknowns_no(unknown_no_filename);
+    if(n < 1){
+        printf("cannot read the number of unknowns from %s\n", unknown_no_filename);
+        n = 0;
+        return NULL;
+    }
+    double * free_terms = new double[n];
+    std::ifstream free_terms_file(free_terms_filename);
+    for(int eq_id = 0; eq_id < n && free_terms_file; eq_id++)free_terms[eq_id] = read_free_term(free_terms_file, convention);
+    if(!free_terms_file){
+        printf("cannot read %d free terms from %s\n", n, free_terms_filename);
+        delete[] free_terms;
+        n = 0;
+        return NULL;
+    }
+    free_terms_file.close();
+    return free_terms;
+}
+
+void open_coefficient_file(std::ifstream & coeff_file, const char * coeff_filename, coefficient_file_format format){
+    if(format == BINARY_COEFFICIENTS)coeff_file.open(coeff_filename, std::ios_base::binary);
+    else coeff_file.open(coeff_filename);
+    if(!coeff_file.is_open())printf("cannot open the coefficient file %s\n", coeff_filename);
+}
+
+/**
+ * @brief The reader thread: parse the rows n - 1, n - 2, ..., 0 of a bottom-up coefficient file
+ * (see write_coefficient_matrix_in_order and write_binary_coefficient_matrix) and queue them.
+ * Row i is queued as its n - i coefficients, starting with the diagonal. If the file cannot be
+ * opened or a row cannot be read, a NULL row is queued instead and the thread stops.
+ */
+void row_reader_thread(const char * coeff_filename, coefficient_file_format format, coefficient_convention convention, int n, bounded_row_queue * queue){
+    std::ifstream coeff_file;
+    open_coefficient_file(coeff_file, coeff_filename, format);
+    if(!coeff_file.is_open()){
+        push_row(queue, NULL);
+        return;
+    }
+    for(int row_id = n - 1; row_id > -1; row_id--){
+        double * row = new double[n - row_id];
+        if(!read_bottom_up_row(coeff_file, format, convention, row, n - row_id)){
+            printf("cannot read row %d of the coefficient file %s\n", row_id, coeff_filename);
+            delete[] row;
+            push_row(queue, NULL);
+            return;
+        }
+        push_row(queue, row);
+    }
+    coeff_file.close();
+}
+
+/**
+ * @brief Read a system whose coefficient file was written with BOTTOM_UP_ROWS, without solving
+ * it: the load-only half of pipelined_load_and_solve.
+ *
+ * @param coeff_filename The name of the file that stores the coefficient matrix, bottom-up
+ * @param free_terms_filename The name of the file that stores the free terms
+ * @param unknown_no_filename The name of the file that stores the number of unknowns
+ * @param format Whether the coefficient file is text or raw doubles
+ * @param convention How the values of the files are read (see coefficient_convention)
+ * @return TriangularSystem The system, with no unknowns if a file cannot be read
+ */
+TriangularSystem read_bottom_up_system(const char * coeff_filename, const char * free_terms_filename, const char * unknown_no_filename, coefficient_file_format format,
+                                      coefficient_convention convention){
+    int n = 0;
+    double * free_terms = read_pipeline_free_terms(free_terms_filename, unknown_no_filename, convention, n);
+    if(free_terms == NULL)return TriangularSystem(0);
+    std::ifstream coeff_file;
+    open_coefficient_file(coeff_file, coeff_filename, format);
+    if(!coeff_file.is_open()){
+        delete[] free_terms;
+        return TriangularSystem(0);
+    }
+
+    TriangularSystem system(n);
+    for(int row_id = 0; row_id < n; row_id++)system.free_terms()[row_id] = free_terms[row_id];
+    delete[] free_terms;
+    for(int row_id = n - 1; row_id > -1; row_id--){
+        if(!read_bottom_up_row(coeff_file, format, convention, system.row(row_id) + row_id, n - row_id)){
+            printf("cannot read row %d of the coefficient file %s\n", row_id, coeff_filename);
+            return TriangularSystem(0);
+        }
+    }
+    coeff_file.close();
+    return system;
+}
+
+/**
+ * @brief Read and solve the system at the same time. A reader thread streams the rows from the
+ * last one up, while the calling thread solves them by batches of PIPELINE_BATCH_ROWS as soon as
+ * they arrive: the threads first subtract the unknowns known before the batch from all its rows
+ * at once, then the triangle of the batch is solved in order, and the rows are freed. The parsing
+ * time hides the solve, and only PIPELINE_QUEUE_CAPACITY + PIPELINE_BATCH_ROWS rows are in memory
+ * at any moment. The coefficient file must have been written with BOTTOM_UP_ROWS.
+ *
+ * @param coeff_filename The name of the file that stores the coefficient matrix, bottom-up
+ * @param free_terms_filename The name of the file that stores the free terms
+ * @param unknown_no_filename The name of the file that stores the number of unknowns
+ * @param format Whether the coefficient file is text or raw doubles
+ * @param number_of_threads The number of OpenMP threads of the solver
+ * @param convention How the values of the files are read (see coefficient_convention)
+ * @return double* The solution of the system, or NULL if a file cannot be read
+ */
+double * pipelined_load_and_solve(const char * coeff_filename, const char * free_terms_filename, const char * unknown_no_filename, coefficient_file_format format, int number_of_threads,
+                                  coefficient_convention convention){
+    int n = 0;
+    double * solution = read_pipeline_free_terms(free_terms_filename, unknown_no_filename, convention, n);
+    if(solution == NULL)return NULL;
+
+    bounded_row_queue queue;
+    queue.head = 0;
+    queue.size = 0;
+    std::thread reader(row_reader_thread, coeff_filename, format, convention, n, &queue);
+
+    /* batch[i] is the row last_row - 1 - i: */
+    double * batch[PIPELINE_BATCH_ROWS];
+    bool failed = false;
+    for(int last_row = n; last_row > 0 && !failed; last_row -= PIPELINE_BATCH_ROWS){
+        int first_row = (last_row > PIPELINE_BATCH_ROWS) ? last_row - PIPELINE_BATCH_ROWS : 0;
+        int rows_no = last_row - first_row;
+        for(int i = 0; i < rows_no; i++){
+            batch[i] = pop_row(&queue);
+            if(batch[i] == NULL){
+                for(int j = 0; j < i; j++)delete[] batch[j];
+                failed = true;
+                break;
+            }
+        }
+        if(failed)break;
+
+        #pragma omp parallel for schedule(static) num_threads(number_of_threads)
+        for(int i = 0; i < rows_no; i++){
+            int row_id = last_row - 1 - i;
+            double sum = 0.0;
+            for(int col_id = last_row; col_id < n; col_id++)sum += batch[i][col_id - row_id] * solution[col_id];
+            solution[row_id] -= sum;
+        }
+
+        for(int i = 0; i < rows_no; i++){
+            int row_id = last_row - 1 - i;
+            double * row = batch[i];
+            double sum = solution[row_id];
+            for(int col_id = row_id + 1; col_id < last_row; col_id++)sum -= row[col_id - row_id] * solution[col_id];
+            if(row[0] != 0)solution[row_id] = sum / row[0];
+            else solution[row_id] = 0;
+            delete[] row;
+        }
+    }
+
+    reader.join();
+    if(failed){
+        delete[] solution;
+        return NULL;
+    }
+    return solution;
+}
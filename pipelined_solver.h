@@ -0,0 +1,20 @@
+#include "linear_system_schema.h"
+#include "solver_library.h"
+
+#ifndef PIPELINED_SOLVER_H
+#define PIPELINED_SOLVER_H
+
+/* The number of rows the reader thread can be ahead of the solver: */
+#define PIPELINE_QUEUE_CAPACITY 64
+/* The solver takes the rows by batches of this many (at most PIPELINE_QUEUE_CAPACITY): */
+#define PIPELINE_BATCH_ROWS 32
+
+enum coefficient_file_format { TEXT_COEFFICIENTS, BINARY_COEFFICIENTS };
+
+TriangularSystem read_bottom_up_system(const char * coeff_filename, const char * free_terms_filename, const char * unknown_no_filename, coefficient_file_format format,
+                                      coefficient_convention convention = READER_CONVENTION);
+
+double * pipelined_load_and_solve(const char * coeff_filename, const char * free_terms_filename, const char * unknown_no_filename, coefficient_file_format format, int number_of_threads,
+                                  coefficient_convention convention = READER_CONVENTION);
+
+#endif
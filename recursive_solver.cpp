@@ -0,0 +1,146 @@
+#include "recursive_solver.h"
+#include "reproducible_solver.h"
+
+/**
+ * @brief Plain back-substitution on the triangle [first_row, last_row) x [first_row, last_row).
+ * The contributions of the columns after last_row must already be subtracted from x.
+ *
+ * @param coefficients The coefficient matrix
+ * @param x The right hand sides on input, the solutions on output (rhs_no values per row)
+ * @param first_row The first row of the triangle
+ * @param last_row One past the last row of the triangle
+ * @param rhs_no The number of right hand sides
+ */
+void solve_base_triangle(double ** coefficients, double * x, int first_row, int last_row, int rhs_no){
+    for(int row_id = last_row - 1; row_id >= first_row; row_id--){
+        double * row = coefficients[row_id];
+        double * x_row = x + (long long)row_id * rhs_no;
+        for(int col_id = row_id + 1; col_id < last_row; col_id++){
+            double coefficient = row[col_id];
+            double * x_col = x + (long long)col_id * rhs_no;
+            for(int rhs_id = 0; rhs_id < rhs_no; rhs_id++)x_row[rhs_id] -= coefficient * x_col[rhs_id];
+        }
+        for(int rhs_id = 0; rhs_id < rhs_no; rhs_id++){
+            if(row[row_id] != 0)x_row[rhs_id] /= row[row_id];
+            else x_row[rhs_id] = 0;
+        }
+    }
+}
+
+/**
+ * @brief Subtract the off-diagonal rectangle [first_row, middle_row) x [middle_row, last_row)
+ * times the already solved x[middle_row .. last_row) from x[first_row .. middle_row).
+ * The rows are independent, so they are split in tasks.
+ */
+void update_rectangle(double ** coefficients, double * x, int first_row, int middle_row, int last_row, int rhs_no){
+    #pragma omp taskloop grainsize(RECURSIVE_TASK_ROWS) default(none) shared(coefficients, x) firstprivate(middle_row, last_row, rhs_no)
+    for(int row_id = first_row; row_id < middle_row; row_id++){
+        double * row = coefficients[row_id];
+        double * x_row = x + (long long)row_id * rhs_no;
+        for(int col_id = middle_row; col_id < last_row; col_id++){
+            double coefficient = row[col_id];
+            double * x_col = x + (long long)col_id * rhs_no;
+            for(int rhs_id = 0; rhs_id < rhs_no; rhs_id++)x_row[rhs_id] -= coefficient * x_col[rhs_id];
+        }
+    }
+}
+
+/**
+ * @brief Solve the triangle [first_row, last_row) by splitting it into two half-size triangles
+ * and the rectangle between them: first the bottom triangle, then the rectangle update,
+ * then the top triangle. The recursion adapts itself to every cache level, without any
+ * machine specific block size.
+ */
+void solve_recursive_triangle(double ** coefficients, double * x, int first_row, int last_row, int rhs_no){
+    if(last_row - first_row <= RECURSIVE_BASE_CASE){
+        solve_base_triangle(coefficients, x, first_row, last_row, rhs_no);
+        return;
+    }
+    int middle_row = first_row + (last_row - first_row) / 2;
+    solve_recursive_triangle(coefficients, x, middle_row, last_row, rhs_no);
+    update_rectangle(coefficients, x, first_row, middle_row, last_row, rhs_no);
+    solve_recursive_triangle(coefficients, x, first_row, middle_row, rhs_no);
+}
+
+/**
+ * @brief Solve the system for several right hand sides at once; the rectangle updates then
+ * become matrix-matrix products.
+ *
+ * @param lse The linear system of equations (its free terms are not used)
+ * @param free_terms The right hand sides, rhs_no values per row: free_terms[row * rhs_no + rhs_id]
+ * @param rhs_no The number of right hand sides
+ * @param number_of_threads The number of OpenMP threads running the rectangle update tasks
+ * @return double* The solutions, with the same layout as free_terms
+ */
+double * recursive_multiple_rhs_solver(linear_system_of_equations lse, double * free_terms, int rhs_no, int number_of_threads){
+    int n = lse.unknowns_no;
+    double * x = new double[(long long)n * rhs_no];
+    for(long long i = 0; i < (long long)n * rhs_no; i++)x[i] = free_terms[i];
+
+    #pragma omp parallel num_threads(number_of_threads)
+    #pragma omp single
+    solve_recursive_triangle(lse.coefficients, x, 0, n, rhs_no);
+
+    return x;
+}
+
+/**
+ * @brief The recursive (cache-oblivious) solver for the free terms of the system.
+ *
+ * @param lse The linear system of equations
+ * @param number_of_threads The number of OpenMP threads
+ * @return double* The solution of the system
+ */
+double * recursive_system_solver(linear_system_of_equations lse, int number_of_threads){
+    return recursive_multiple_rhs_solver(lse, lse.free_terms, 1, number_of_threads);
+}
+
+/**
+ * @brief The recursion of the reproducible mode: the triangles are split on multiples of
+ * REPRODUCIBLE_BLOCK_SIZE down to single blocks, and the rectangle updates subtract the partial
+ * sum of each of their blocks on its own, last block first. Every row then sees the fixed order
+ * of reproducible_solver.h, whatever the number of threads running the tasks.
+ */
+void solve_reproducible_triangle(double ** coefficients, double * residual, double * x, int first_row, int last_row){
+    int blocks_no = (last_row - first_row + REPRODUCIBLE_BLOCK_SIZE - 1) / REPRODUCIBLE_BLOCK_SIZE;
+    if(blocks_no <= 1){
+        reproducible_solve_diagonal_block(coefficients, residual, x, first_row, last_row);
+        return;
+    }
+    int middle_row = first_row + blocks_no / 2 * REPRODUCIBLE_BLOCK_SIZE;
+    solve_reproducible_triangle(coefficients, residual, x, middle_row, last_row);
+
+    #pragma omp taskloop grainsize(RECURSIVE_TASK_ROWS) default(none) shared(coefficients, residual, x) firstprivate(middle_row, last_row)
+    for(int row_id = first_row; row_id < middle_row; row_id++){
+        int last_block = (last_row - 1) / REPRODUCIBLE_BLOCK_SIZE;
+        for(int block_id = last_block; block_id >= middle_row / REPRODUCIBLE_BLOCK_SIZE; block_id--){
+            int first = block_id * REPRODUCIBLE_BLOCK_SIZE;
+            int last = (first + REPRODUCIBLE_BLOCK_SIZE < last_row) ? first + REPRODUCIBLE_BLOCK_SIZE : last_row;
+            residual[row_id] -= reproducible_block_dot(coefficients[row_id], x, first, last);
+        }
+    }
+
+    solve_reproducible_triangle(coefficients, residual, x, first_row, middle_row);
+}
+
+/**
+ * @brief The recursive solver in the fixed accumulation order of the reproducible mode: the
+ * result has the same bits as reproducible_system_solver, for any number of threads.
+ *
+ * @param lse The linear system of equations
+ * @param number_of_threads The number of OpenMP threads
+ * @return double* The solution of the system
+ */
+double * recursive_reproducible_solver(linear_system_of_equations lse, int number_of_threads){
+    int n = lse.unknowns_no;
+    double * x = new double[n];
+    double * residual = new double[n];
+    for(int i = 0; i < n; i++)residual[i] = lse.free_terms[i];
+
+    #pragma omp parallel num_threads(number_of_threads)
+    #pragma omp single
+    solve_reproducible_triangle(lse.coefficients, residual, x, 0, n);
+
+    delete[] residual;
+    return x;
+}
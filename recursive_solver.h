@@ -0,0 +1,17 @@
+#include "linear_system_schema.h"
+
+#ifndef RECURSIVE_SOLVER_H
+#define RECURSIVE_SOLVER_H
+
+/* Below this size, the triangles are solved with the plain back-substitution: */
+#define RECURSIVE_BASE_CASE 64
+/* The number of rows of the off-diagonal rectangle handled by one task: */
+#define RECURSIVE_TASK_ROWS 32
+
+double * recursive_system_solver(linear_system_of_equations lse, int number_of_threads);
+
+double * recursive_multiple_rhs_solver(linear_system_of_equations lse, double * free_terms, int rhs_no, int number_of_threads);
+
+double * recursive_reproducible_solver(linear_system_of_equations lse, int number_of_threads);
+
+#endif
@@ -0,0 +1,37 @@
+#include "reproducible_solver.h"
+
+/**
+ * @brief The blocked back-substitution in the fixed order of the reproducible mode: the
+ * diagonal block is solved by one thread, then the rows above it subtract the partial sum of
+ * the block, split between the threads. A row is only ever touched by one thread per block,
+ * so the number of threads never changes the result.
+ *
+ * @param lse The linear system of equations
+ * @param number_of_threads The number of OpenMP threads
+ * @return double* The solution of the system
+ */
+double * reproducible_system_solver(linear_system_of_equations lse, int number_of_threads){
+    int n = lse.unknowns_no;
+    double ** coefficients = lse.coefficients;
+    double * x = new double[n];
+    double * residual = new double[n];
+    for(int i = 0; i < n; i++)residual[i] = lse.free_terms[i];
+    int blocks_no = (n + REPRODUCIBLE_BLOCK_SIZE - 1) / REPRODUCIBLE_BLOCK_SIZE;
+
+    #pragma omp parallel default(none) shared(coefficients, x, residual, n, blocks_no) num_threads(number_of_threads)
+    {
+        for(int block_id = blocks_no - 1; block_id > -1; block_id--){
+            int first = block_id * REPRODUCIBLE_BLOCK_SIZE;
+            int last = (first + REPRODUCIBLE_BLOCK_SIZE < n) ? first + REPRODUCIBLE_BLOCK_SIZE : n;
+
+            #pragma omp single
+            reproducible_solve_diagonal_block(coefficients, residual, x, first, last);
+
+            #pragma omp for schedule(static)
+            for(int i = 0; i < first; i++)residual[i] -= reproducible_block_dot(coefficients[i], x, first, last);
+        }
+    }
+
+    delete[] residual;
+    return x;
+}
@@ -0,0 +1,42 @@
+#include "linear_system_schema.h"
+
+#ifndef REPRODUCIBLE_SOLVER_H
+#define REPRODUCIBLE_SOLVER_H
+
+/* The width of the column blocks of the fixed accumulation order: */
+#define REPRODUCIBLE_BLOCK_SIZE 64
+
+/*
+ * The fixed accumulation order of the reproducible mode. The columns are cut into blocks of
+ * REPRODUCIBLE_BLOCK_SIZE, aligned on column 0. For row i, the contribution of every block is
+ * first summed on its own, from left to right, starting from 0 (reproducible_block_dot); the
+ * partial sums of the blocks are then subtracted from the free term one at a time, from the last
+ * block to the block of the diagonal; x[i] is the result divided by the diagonal.
+ * This only depends on n, so every back-end that follows it gives the same bits for any number
+ * of threads or ranks. Build without -ffast-math, so that the compiler keeps the order.
+ */
+
+/**
+ * @brief The partial sum of one block of a row: row[begin..end) . x[begin..end), left to right.
+ */
+inline double reproducible_block_dot(const double * row, const double * x, int begin, int end){
+    double sum = 0.0;
+    for(int j = begin; j < end; j++)sum += row[j] * x[j];
+    return sum;
+}
+
+/**
+ * @brief Solve the diagonal block [first, last) once the partial sums of the later blocks have
+ * been subtracted from residual[first..last). A null diagonal gives 0, as in the other solvers.
+ */
+inline void reproducible_solve_diagonal_block(double ** coefficients, const double * residual, double * x, int first, int last){
+    for(int i = last - 1; i >= first; i--){
+        double value = residual[i] - reproducible_block_dot(coefficients[i], x, i + 1, last);
+        if(coefficients[i][i] != 0)x[i] = value / coefficients[i][i];
+        else x[i] = 0;
+    }
+}
+
+double * reproducible_system_solver(linear_system_of_equations lse, int number_of_threads);
+
+#endif
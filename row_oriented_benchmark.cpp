@@ -0,0 +1,66 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+
+#include <chrono>
+#include <vector>
+
+#include "solver_library.h"
+
+#define NUM_THREADS 40
+#define BENCHMARK_RUNS 3
+
+/**
+ * @brief A diagonally dominant system, so that the solutions of the back-ends can be compared.
+ */
+TriangularSystem generate_dominant_system(int n){
+    TriangularSystem result(n);
+    for(int row_id = 0; row_id < n; row_id++){
+        double * row = result.row(row_id);
+        for(int col_id = row_id + 1; col_id < n; col_id++)row[col_id] = (double)rand() / RAND_MAX;
+        row[row_id] = n + (double)rand() / RAND_MAX;
+        result.free_terms()[row_id] = (double)rand() / RAND_MAX;
+    }
+    return result;
+}
+
+/**
+ * @brief Usage: row_oriented_benchmark [threads] [block_size]
+ * The column-oriented push form (open_mp) against the row-oriented pull form and the blocked
+ * push/pull hybrids, from narrow to wide rows; the best of BENCHMARK_RUNS solves is reported.
+ */
+int main(int argc, char ** argv){
+    int number_of_threads = (argc > 1) ? atoi(argv[1]) : NUM_THREADS;
+    int block_size = (argc > 2) ? atoi(argv[2]) : 0;
+    const int sizes[] = {500, 2000, 8000};
+    const char * backend_names[] = {"open_mp (push)", "row_pull", "hybrid_push", "hybrid_pull"};
+    solver_backend backends[] = {OPEN_MP_BACKEND, ROW_PULL_BACKEND, HYBRID_PUSH_BACKEND, HYBRID_PULL_BACKEND};
+
+    for(int size_id = 0; size_id < 3; size_id++){
+        int n = sizes[size_id];
+        TriangularSystem system = generate_dominant_system(n);
+        std::vector<double> reference;
+        printf("\n=== n = %d, threads = %d ===\n", n, number_of_threads);
+        for(int backend_id = 0; backend_id < 4; backend_id++){
+            std::unique_ptr<Solver> solver = make_solver(backends[backend_id], number_of_threads, block_size);
+            std::vector<double> solution;
+            double best_seconds = 1e30;
+            for(int run = 0; run < BENCHMARK_RUNS; run++){
+                std::chrono::high_resolution_clock::time_point begin = std::chrono::high_resolution_clock::now();
+                solution = solver->solve(system);
+                std::chrono::high_resolution_clock::time_point end = std::chrono::high_resolution_clock::now();
+                double seconds = std::chrono::duration_cast<std::chrono::nanoseconds>(end - begin).count() * 1e-9;
+                if(seconds < best_seconds)best_seconds = seconds;
+            }
+            if(backend_id == 0)reference = solution;
+            double largest_difference = 0.0;
+            for(int i = 0; i < n; i++){
+                double difference = fabs(solution[i] - reference[i]) / (fabs(reference[i]) > 0 ? fabs(reference[i]) : 1.0);
+                if(difference > largest_difference)largest_difference = difference;
+            }
+            printf("%-16s %10.6f s  %8.3f GFLOP/s  largest relative difference %e\n",
+                   backend_names[backend_id], best_seconds, (double)n * n / best_seconds * 1e-9, largest_difference);
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,136 @@
+#include "row_oriented_solver.h"
+#include <math.h>
+#include <omp.h>
+#include <sched.h>
+
+#include <atomic>
+
+/**
+ * @brief The partial dot product of one thread, and the step it belongs to; padded to a cache
+ * line, so that the threads of the tree do not write the same lines.
+ */
+struct pull_partial {
+    double value;
+    std::atomic<int> step;
+    char padding[64 - sizeof(double) - sizeof(std::atomic<int>)];
+};
+
+void spin_until_step(const std::atomic<int> & step, int target){
+    int polls = 0;
+    while(step.load(std::memory_order_acquire) < target){
+        if(++polls == PULL_SPIN_BEFORE_YIELD){
+            polls = 0;
+            sched_yield();
+        }
+    }
+}
+
+/**
+ * @brief The first column of a thread. Column j is used by the rows 0 .. j - 1, so the columns
+ * are cut where the triangle's area splits evenly: at n * sqrt(t / threads).
+ */
+int pull_column_begin(int n, int thread_index, int threads_no){
+    return (int)floor(n * sqrt((double)thread_index / threads_no) + 0.5);
+}
+
+/**
+ * @brief The fine-grained pull form: every unknown is one parallel dot product. Each thread owns
+ * a fixed range of columns and computes its part of row i's suffix . x with SIMD; the parts are
+ * combined by a binary tree in which every thread only waits for the flag of its partner, and
+ * thread 0 (the root) solves x[i] and publishes it. There is no barrier: one flag broadcast and
+ * log2(threads) pairwise waits per unknown.
+ *
+ * @param lse The linear system of equations
+ * @param number_of_threads The number of OpenMP threads
+ * @return double* The solution of the system
+ */
+double * row_pull_solver(linear_system_of_equations lse, int number_of_threads){
+    int n = lse.unknowns_no;
+    double * solution = new double[n];
+    pull_partial * partials = new pull_partial[number_of_threads];
+    for(int thread_index = 0; thread_index < number_of_threads; thread_index++)partials[thread_index].step.store(0);
+    /* The number of unknowns solved so far; x[n - solved .. n) are known: */
+    std::atomic<int> solved(0);
+
+    #pragma omp parallel num_threads(number_of_threads)
+    {
+        int thread_index = omp_get_thread_num();
+        int threads_no = omp_get_num_threads();
+        int column_begin = pull_column_begin(n, thread_index, threads_no);
+        int column_end = pull_column_begin(n, thread_index + 1, threads_no);
+
+        for(int row_id = n - 1; row_id > -1; row_id--){
+            int step = n - row_id;
+            spin_until_step(solved, step - 1);
+            int begin = (column_begin > row_id + 1) ? column_begin : row_id + 1;
+            double partial = (begin < column_end) ? row_dot(lse.coefficients[row_id], solution, begin, column_end) : 0.0;
+
+            bool published = false;
+            for(int width = 1; width < threads_no; width *= 2){
+                if(thread_index % (2 * width) != 0){
+                    partials[thread_index].value = partial;
+                    partials[thread_index].step.store(step, std::memory_order_release);
+                    published = true;
+                    break;
+                }
+                if(thread_index + width < threads_no){
+                    spin_until_step(partials[thread_index + width].step, step);
+                    partial += partials[thread_index + width].value;
+                }
+            }
+            if(!published){
+                if(lse.coefficients[row_id][row_id] != 0)solution[row_id] = (lse.free_terms[row_id] - partial) / lse.coefficients[row_id][row_id];
+                else solution[row_id] = 0;
+                solved.store(step, std::memory_order_release);
+            }
+        }
+    }
+
+    delete[] partials;
+    return solution;
+}
+
+/**
+ * @brief The blocked hybrids: the columns are cut into blocks of block_size from the last one;
+ * one thread solves every diagonal block in the pull form, and the rest of the work is row
+ * dot products shared by the threads. With PUSH_BLOCKS, once a block is solved every row above
+ * it subtracts row[first..last) . x[first..last) from its sum; with PULL_BLOCKS, before a block
+ * is solved each of its rows subtracts row[last..n) . x[last..n). Both take two barriers per
+ * block instead of two per unknown, and only read the rows contiguously.
+ *
+ * @param lse The linear system of equations
+ * @param number_of_threads The number of OpenMP threads
+ * @param block_size The width of the blocks (0 for ROW_ORIENTED_BLOCK_SIZE)
+ * @param update PUSH_BLOCKS or PULL_BLOCKS
+ * @return double* The solution of the system
+ */
+double * blocked_hybrid_solver(linear_system_of_equations lse, int number_of_threads, int block_size, hybrid_update update){
+    int n = lse.unknowns_no;
+    if(block_size <= 0)block_size = ROW_ORIENTED_BLOCK_SIZE;
+    double * solution = new double[n];
+    double * sum = new double[n];
+    for(int i = 0; i < n; i++)sum[i] = lse.free_terms[i];
+
+    #pragma omp parallel num_threads(number_of_threads)
+    {
+        for(int last = n; last > 0; last -= block_size){
+            int first = (last > block_size) ? last - block_size : 0;
+
+            if(update == PULL_BLOCKS){
+                #pragma omp for schedule(static)
+                for(int row_id = first; row_id < last; row_id++)sum[row_id] -= row_dot(lse.coefficients[row_id], solution, last, n);
+            }
+
+            #pragma omp single
+            pull_diagonal_block(lse.coefficients, sum, solution, first, last);
+
+            if(update == PUSH_BLOCKS){
+                #pragma omp for schedule(static)
+                for(int row_id = 0; row_id < first; row_id++)sum[row_id] -= row_dot(lse.coefficients[row_id], solution, first, last);
+            }
+        }
+    }
+
+    delete[] sum;
+    return solution;
+}
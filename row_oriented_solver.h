@@ -0,0 +1,49 @@
+#include "linear_system_schema.h"
+
+#ifndef ROW_ORIENTED_SOLVER_H
+#define ROW_ORIENTED_SOLVER_H
+
+/* The default width of the column blocks of the blocked hybrids: */
+#define ROW_ORIENTED_BLOCK_SIZE 128
+/* A waiting thread gives its core away after this many polls: */
+#define PULL_SPIN_BEFORE_YIELD 1000
+
+/*
+ * The "pull" (row-oriented, dot product) forms of the back-substitution: x[i] is computed from
+ * row i's suffix and the unknowns already solved, so the rows are read contiguously, where the
+ * "push" form of open_mp_parallel_solver walks a column of the row-major matrix.
+ */
+
+/**
+ * @brief row[begin..end) . x[begin..end), vectorized.
+ */
+inline double row_dot(const double * row, const double * x, int begin, int end){
+    double sum = 0.0;
+    #pragma omp simd reduction(+:sum)
+    for(int j = begin; j < end; j++)sum += row[j] * x[j];
+    return sum;
+}
+
+/**
+ * @brief Solve the diagonal block [first, last) in the pull form, once residual[first..last)
+ * holds the free terms minus the contributions of the columns after last.
+ */
+inline void pull_diagonal_block(double ** coefficients, const double * residual, double * x, int first, int last){
+    for(int i = last - 1; i >= first; i--){
+        double value = residual[i] - row_dot(coefficients[i], x, i + 1, last);
+        if(coefficients[i][i] != 0)x[i] = value / coefficients[i][i];
+        else x[i] = 0;
+    }
+}
+
+/* How the blocked hybrids apply the solved blocks to the other rows: */
+enum hybrid_update {
+    PUSH_BLOCKS,    /* after each block, all the rows above pull it (right-looking) */
+    PULL_BLOCKS     /* before each block, its rows pull all the solved columns (left-looking) */
+};
+
+double * row_pull_solver(linear_system_of_equations lse, int number_of_threads);
+
+double * blocked_hybrid_solver(linear_system_of_equations lse, int number_of_threads, int block_size, hybrid_update update);
+
+#endif
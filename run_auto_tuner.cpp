@@ -0,0 +1,44 @@
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "auto_tuner.h"
+
+#define NUM_THREADS 40
+
+/* The sizes measured by default; a full sweep of n = 10000 takes too long to run by default: */
+#define DEFAULT_TUNING_SIZES_NO 2
+const int default_tuning_sizes[DEFAULT_TUNING_SIZES_NO] = {100, 1000};
+
+/**
+ * @brief Measure the back-ends on this machine and write the tuning file. Usage:
+ * run_auto_tuner [max_threads [tuning_file [size ...]]]
+ */
+int main(int argc, char ** argv){
+    int max_threads = (argc > 1) ? atoi(argv[1]) : NUM_THREADS;
+    const char * tuning_filename = (argc > 2) ? argv[2] : TUNING_FILENAME;
+    if(max_threads < 1)max_threads = 1;
+
+    std::vector<int> sizes(default_tuning_sizes, default_tuning_sizes + DEFAULT_TUNING_SIZES_NO);
+    if(argc > 3)sizes.clear();
+    for(int arg_id = 3; arg_id < argc; arg_id++){
+        int size = atoi(argv[arg_id]);
+        if(size < 1){
+            printf("invalid size %s\n", argv[arg_id]);
+            return 1;
+        }
+        sizes.push_back(size);
+    }
+    int rhs_counts[] = {1, 16};
+    std::vector<tuning_entry> table = run_auto_tuning(sizes.data(), (int)sizes.size(), rhs_counts, 2, max_threads);
+    write_tuning_table(table, tuning_filename);
+
+    /* Check the table with the tuned solver on a read system: */
+    std::vector<tuning_entry> read_table = read_tuning_table(tuning_filename);
+    std::unique_ptr<Solver> solver = make_tuned_solver(read_table);
+    TriangularSystem system = TriangularSystem::read("a_input_1000.txt", "free_terms_1000.txt", "unknown_no_1000.txt");
+    tuning_entry entry = choose_tuning_entry(read_table, system.unknowns_no(), 1);
+    std::vector<double> solution = solver->solve(system);
+    printf("n = %d solved with backend %d, %d threads, block size %d; x[0] = %e\n",
+           system.unknowns_no(), (int)entry.backend, entry.number_of_threads, entry.block_size, solution[0]);
+    return 0;
+}
@@ -0,0 +1,232 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#include <algorithm>
+#include <chrono>
+#include <vector>
+
+#include "solver_library.h"
+
+/* Every point is timed this many times; the median is reported: */
+#define SCALING_REPETITIONS 3
+/* The seed of the generated systems, so every run of the study solves the same systems: */
+#define SCALING_SEED 20221
+/* The generator and the MPI solver; the launcher can be replaced with the SCALING_MPIRUN variable: */
+#define GENERATOR_COMMAND "./system_generator.exe"
+#define MPI_SOLVER_COMMAND "./mpi_assignment.exe"
+#define MPIRUN_COMMAND "mpirun --oversubscribe"
+/* The values the thread sweep reads: those of TriangularSystem::read, which is also how
+ * mpi_assignment reads its input, so both sweeps solve the same system: */
+#define SCALING_CONVENTION READER_CONVENTION
+
+enum scaling_kind { STRONG_SCALING, WEAK_SCALING };
+
+/**
+ * @brief One measured point of a sweep: p threads or ranks solving a system of n unknowns.
+ */
+struct scaling_point {
+    scaling_kind kind;
+    const char * runner;
+    int processes_no;
+    int unknowns_no;
+    double seconds;
+};
+
+struct scaling_input {
+    char coeff_filename[64];
+    char free_terms_filename[64];
+    char unknown_no_filename[64];
+};
+
+double elapsed_seconds(std::chrono::high_resolution_clock::time_point begin){
+    std::chrono::high_resolution_clock::time_point end = std::chrono::high_resolution_clock::now();
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(end - begin).count() * 1e-9;
+}
+
+double median(std::vector<double> values){
+    if(values.empty())return -1.0;
+    std::sort(values.begin(), values.end());
+    return values[values.size() / 2];
+}
+
+/**
+ * @brief Write the seeded system of n unknowns with system_generator, unless it is already there.
+ * The generator writes temporary files, which are renamed once it has succeeded, the unknowns
+ * file last: so an interrupted run never leaves a partial system that a later run would reuse.
+ *
+ * @return bool false if the generator failed
+ */
+bool prepare_input(int n, scaling_input & input){
+    /* snprintf returns the length it needed; a name or command that does not fit is an error: */
+    if(snprintf(input.coeff_filename, sizeof(input.coeff_filename), "scaling_a_input_%d.txt", n) >= (int)sizeof(input.coeff_filename)
+        || snprintf(input.free_terms_filename, sizeof(input.free_terms_filename), "scaling_free_terms_%d.txt", n) >= (int)sizeof(input.free_terms_filename)
+        || snprintf(input.unknown_no_filename, sizeof(input.unknown_no_filename), "scaling_unknown_no_%d.txt", n) >= (int)sizeof(input.unknown_no_filename))return false;
+    FILE * existing = fopen(input.unknown_no_filename, "r");
+    if(existing){
+        fclose(existing);
+        return true;
+    }
+    scaling_input temporary;
+    if(snprintf(temporary.coeff_filename, sizeof(temporary.coeff_filename), "%s.tmp", input.coeff_filename) >= (int)sizeof(temporary.coeff_filename)
+        || snprintf(temporary.free_terms_filename, sizeof(temporary.free_terms_filename), "%s.tmp", input.free_terms_filename) >= (int)sizeof(temporary.free_terms_filename)
+        || snprintf(temporary.unknown_no_filename, sizeof(temporary.unknown_no_filename), "%s.tmp", input.unknown_no_filename) >= (int)sizeof(temporary.unknown_no_filename))return false;
+    char command[512];
+    if(snprintf(command, sizeof(command), "%s %d %u %s %s %s", GENERATOR_COMMAND, n, (unsigned int)SCALING_SEED,
+                temporary.coeff_filename, temporary.free_terms_filename, temporary.unknown_no_filename) >= (int)sizeof(command))return false;
+    if(system(command) != 0){
+        remove(temporary.coeff_filename);
+        remove(temporary.free_terms_filename);
+        remove(temporary.unknown_no_filename);
+        return false;
+    }
+    return rename(temporary.coeff_filename, input.coeff_filename) == 0
+        && rename(temporary.free_terms_filename, input.free_terms_filename) == 0
+        && rename(temporary.unknown_no_filename, input.unknown_no_filename) == 0;
+}
+
+/**
+ * @brief Time the solve (not the load) of the OpenMP back-end with number_of_threads threads.
+ */
+double time_threads(const scaling_input & input, int number_of_threads){
+    TriangularSystem system = TriangularSystem::read(input.coeff_filename, input.free_terms_filename, input.unknown_no_filename, SCALING_CONVENTION);
+    std::unique_ptr<Solver> solver = make_solver(OPEN_MP_BACKEND, number_of_threads);
+    std::vector<double> seconds;
+    for(int repetition = 0; repetition < SCALING_REPETITIONS; repetition++){
+        std::chrono::high_resolution_clock::time_point begin = std::chrono::high_resolution_clock::now();
+        std::vector<double> solution = solver->solve(system);
+        seconds.push_back(elapsed_seconds(begin));
+    }
+    return median(seconds);
+}
+
+/**
+ * @brief Time mpi_assignment on ranks_no local ranks, from the execution_elapsed_time it prints.
+ *
+ * @return double The median time, or -1 if the runs failed
+ */
+double time_ranks(const scaling_input & input, int ranks_no){
+    const char * mpirun = getenv("SCALING_MPIRUN");
+    if(mpirun == NULL)mpirun = MPIRUN_COMMAND;
+    char command[512];
+    if(snprintf(command, sizeof(command), "%s -np %d %s -input %s %s %s 2>/dev/null", mpirun, ranks_no, MPI_SOLVER_COMMAND,
+                input.coeff_filename, input.free_terms_filename, input.unknown_no_filename) >= (int)sizeof(command)){
+        printf("the mpirun command (%s) is too long\n", mpirun);
+        return -1.0;
+    }
+
+    std::vector<double> seconds;
+    for(int repetition = 0; repetition < SCALING_REPETITIONS; repetition++){
+        FILE * output = popen(command, "r");
+        if(output == NULL)break;
+        char line[512];
+        double run_seconds = -1.0;
+        while(fgets(line, sizeof(line), output)){
+            char * found = strstr(line, "execution_elapsed_time:");
+            if(found)run_seconds = atof(found + strlen("execution_elapsed_time:"));
+        }
+        if(pclose(output) != 0 || run_seconds < 0)break;
+        seconds.push_back(run_seconds);
+    }
+    if(seconds.size() < SCALING_REPETITIONS)return -1.0;
+    return median(seconds);
+}
+
+/**
+ * @brief Sweep p = 1, 2, 4, ... up to max_processes (and max_processes itself): at fixed n for
+ * strong scaling, and at n^2 / p constant (n_p = n * sqrt(p), the work of the triangle per
+ * process) for weak scaling.
+ */
+void run_sweep(const char * runner, int n, int max_processes, std::vector<scaling_point> & points){
+    for(int kind = STRONG_SCALING; kind <= WEAK_SCALING; kind++){
+        for(int p = 1; p <= max_processes; p = (p == max_processes) ? p + 1 : std::min(2 * p, max_processes)){
+            scaling_point point;
+            point.kind = (scaling_kind)kind;
+            point.runner = runner;
+            point.processes_no = p;
+            point.unknowns_no = (kind == STRONG_SCALING) ? n : (int)floor(n * sqrt((double)p) + 0.5);
+            scaling_input input;
+            if(!prepare_input(point.unknowns_no, input)){
+                printf("could not generate a system of %d unknowns with %s\n", point.unknowns_no, GENERATOR_COMMAND);
+                return;
+            }
+            if(strcmp(runner, "threads") == 0)point.seconds = time_threads(input, p);
+            else point.seconds = time_ranks(input, p);
+            if(point.seconds < 0){
+                printf("%s: the run with p = %d failed, the sweep stops here\n", runner, p);
+                return;
+            }
+            printf("%s %s p = %d, n = %d: %f s\n", kind == STRONG_SCALING ? "strong" : "weak", runner, p, point.unknowns_no, point.seconds);
+            points.push_back(point);
+        }
+    }
+}
+
+/**
+ * @brief Write the CSV and the summary table. The speedup is T1 / Tp for strong scaling and the
+ * scaled speedup p * T1 / Tp for weak scaling; the efficiency is speedup / p; the Karp-Flatt
+ * serial fraction is (1 / speedup - 1 / p) / (1 - 1 / p), undefined at p = 1.
+ */
+void write_results(const std::vector<scaling_point> & points, const char * csv_filename, const char * summary_filename){
+    FILE * csv = fopen(csv_filename, "w");
+    FILE * summary = fopen(summary_filename, "w");
+    if(csv == NULL || summary == NULL){
+        printf("could not write %s and %s\n", csv_filename, summary_filename);
+        if(csv)fclose(csv);
+        if(summary)fclose(summary);
+        return;
+    }
+    fprintf(csv, "kind,runner,p,n,seconds,speedup,efficiency,karp_flatt\n");
+    fprintf(summary, "%-7s %-8s %5s %8s %12s %9s %11s %11s\n", "kind", "runner", "p", "n", "seconds", "speedup", "efficiency", "karp_flatt");
+
+    for(size_t point_id = 0; point_id < points.size(); point_id++){
+        const scaling_point & point = points[point_id];
+        /* The baseline is the p = 1 point of the same sweep: */
+        double baseline = -1.0;
+        for(size_t other_id = 0; other_id < points.size(); other_id++){
+            if(points[other_id].kind == point.kind && strcmp(points[other_id].runner, point.runner) == 0 && points[other_id].processes_no == 1)
+                baseline = points[other_id].seconds;
+        }
+        int p = point.processes_no;
+        double speedup = baseline / point.seconds;
+        if(point.kind == WEAK_SCALING)speedup *= p;
+        double efficiency = speedup / p;
+        const char * kind_name = point.kind == STRONG_SCALING ? "strong" : "weak";
+
+        if(p > 1){
+            double karp_flatt = (1.0 / speedup - 1.0 / p) / (1.0 - 1.0 / p);
+            fprintf(csv, "%s,%s,%d,%d,%.9f,%.4f,%.4f,%.4f\n", kind_name, point.runner, p, point.unknowns_no, point.seconds, speedup, efficiency, karp_flatt);
+            fprintf(summary, "%-7s %-8s %5d %8d %12.6f %9.3f %11.3f %11.4f\n", kind_name, point.runner, p, point.unknowns_no, point.seconds, speedup, efficiency, karp_flatt);
+        }
+        else{
+            fprintf(csv, "%s,%s,%d,%d,%.9f,%.4f,%.4f,\n", kind_name, point.runner, p, point.unknowns_no, point.seconds, speedup, efficiency);
+            fprintf(summary, "%-7s %-8s %5d %8d %12.6f %9.3f %11.3f %11s\n", kind_name, point.runner, p, point.unknowns_no, point.seconds, speedup, efficiency, "-");
+        }
+    }
+    fclose(csv);
+    fclose(summary);
+}
+
+/**
+ * @brief Usage: scaling_study [n] [max_threads] [max_ranks] [output_prefix]
+ * A max_ranks of 0 skips the MPI sweep. Writes <output_prefix>.csv and <output_prefix>.txt.
+ */
+int main(int argc, char ** argv){
+    int n = (argc > 1) ? atoi(argv[1]) : 2000;
+    int max_threads = (argc > 2) ? atoi(argv[2]) : 40;
+    int max_ranks = (argc > 3) ? atoi(argv[3]) : 8;
+    const char * output_prefix = (argc > 4) ? argv[4] : "scaling_study";
+
+    std::vector<scaling_point> points;
+    if(max_threads > 0)run_sweep("threads", n, max_threads, points);
+    if(max_ranks > 0)run_sweep("ranks", n, max_ranks, points);
+
+    char csv_filename[256];
+    char summary_filename[256];
+    snprintf(csv_filename, sizeof(csv_filename), "%s.csv", output_prefix);
+    snprintf(summary_filename, sizeof(summary_filename), "%s.txt", output_prefix);
+    write_results(points, csv_filename, summary_filename);
+    printf("results written to %s and %s\n", csv_filename, summary_filename);
+    return 0;
+}
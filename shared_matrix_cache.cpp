@@ -0,0 +1,375 @@
+#include "shared_matrix_cache.h"
+#include "system_reader.h"
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <signal.h>
+#include <errno.h>
+#include <stdio.h>
+#include <string.h>
+
+/**
+ * @brief One cached system. A system is published by the process that first asks for it
+ * (ready is 0 while it parses the files) and can be evicted once no process uses it. Every
+ * attachment holds a slot of attacher_pids (0 is a free slot), so that the slots of the
+ * processes that died without detaching can be reclaimed.
+ */
+struct cache_registry_entry {
+    unsigned long long key;
+    long long bytes;
+    int unknowns_no;
+    int attacher_pids[SHARED_CACHE_MAX_ATTACHERS];
+    int ready;
+    int loader_pid;
+    long long last_used;
+};
+
+struct cache_registry {
+    volatile int initialized;
+    pthread_mutex_t mutex;
+    long long clock;
+    cache_registry_entry entries[SHARED_CACHE_MAX_ENTRIES];
+};
+
+/* The layout of a segment: the free terms, then the packed upper triangle (row by row): */
+long long cache_segment_bytes(int n){
+    return sizeof(double) * ((long long)n + (long long)n * (n + 1) / 2);
+}
+
+long long cache_packed_row_offset(int row_id, int n){
+    return (long long)row_id * n - (long long)row_id * (row_id - 1) / 2;
+}
+
+void cache_segment_name(unsigned long long key, char * name){
+    sprintf(name, "%s%016llx", SHARED_CACHE_SEGMENT_PREFIX, key);
+}
+
+/**
+ * @brief The key of a system: the FNV-1a hash of the contents of both input files and of n.
+ * Reading the bytes is much cheaper than parsing them.
+ */
+unsigned long long hash_input_files(char * coeff_filename, char * free_terms_filename, int unknowns_no){
+    unsigned long long hash = 14695981039346656037ULL;
+    char * filenames[2] = {coeff_filename, free_terms_filename};
+    unsigned char * buffer = new unsigned char[1 << 20];
+    for(int file_id = 0; file_id < 2; file_id++){
+        FILE * file = fopen(filenames[file_id], "rb");
+        if(file == NULL)continue;
+        size_t read_bytes;
+        while((read_bytes = fread(buffer, 1, 1 << 20, file)) > 0){
+            for(size_t i = 0; i < read_bytes; i++)hash = (hash ^ buffer[i]) * 1099511628211ULL;
+        }
+        fclose(file);
+    }
+    delete[] buffer;
+    return (hash ^ (unsigned long long)unknowns_no) * 1099511628211ULL;
+}
+
+/**
+ * @brief Map the registry, creating it if this is the first process. The creator initializes the
+ * process-shared (and robust) mutex; the others wait for it to be done.
+ */
+cache_registry * open_cache_registry(){
+    int descriptor = shm_open(SHARED_CACHE_REGISTRY_NAME, O_CREAT | O_EXCL | O_RDWR, 0666);
+    bool creator = (descriptor >= 0);
+    if(!creator)descriptor = shm_open(SHARED_CACHE_REGISTRY_NAME, O_RDWR, 0666);
+    if(descriptor < 0)return NULL;
+
+    if(creator){
+        if(ftruncate(descriptor, sizeof(cache_registry)) != 0){
+            close(descriptor);
+            return NULL;
+        }
+    }
+    else{
+        struct stat segment_stat;
+        while(fstat(descriptor, &segment_stat) == 0 && segment_stat.st_size < (off_t)sizeof(cache_registry))usleep(1000);
+    }
+    void * mapping = mmap(NULL, sizeof(cache_registry), PROT_READ | PROT_WRITE, MAP_SHARED, descriptor, 0);
+    close(descriptor);
+    if(mapping == MAP_FAILED)return NULL;
+    cache_registry * registry = (cache_registry *)mapping;
+
+    if(creator){
+        pthread_mutexattr_t attributes;
+        pthread_mutexattr_init(&attributes);
+        pthread_mutexattr_setpshared(&attributes, PTHREAD_PROCESS_SHARED);
+        pthread_mutexattr_setrobust(&attributes, PTHREAD_MUTEX_ROBUST);
+        pthread_mutex_init(&registry->mutex, &attributes);
+        pthread_mutexattr_destroy(&attributes);
+        __sync_synchronize();
+        registry->initialized = 1;
+    }
+    else{
+        while(registry->initialized == 0)usleep(1000);
+        __sync_synchronize();
+    }
+    return registry;
+}
+
+void lock_cache_registry(cache_registry * registry){
+    /* A process died holding the lock: the registry itself is always left consistent. */
+    if(pthread_mutex_lock(&registry->mutex) == EOWNERDEAD)pthread_mutex_consistent(&registry->mutex);
+}
+
+bool process_is_gone(int pid){
+    return kill(pid, 0) != 0 && errno == ESRCH;
+}
+
+/**
+ * @brief Free the slots of the attached processes that no longer exist (the caller holds the lock).
+ *
+ * @return int The number of processes still attached
+ */
+int reap_dead_attachers(cache_registry_entry & entry){
+    int attachers_no = 0;
+    for(int slot = 0; slot < SHARED_CACHE_MAX_ATTACHERS; slot++){
+        if(entry.attacher_pids[slot] != 0 && process_is_gone(entry.attacher_pids[slot]))entry.attacher_pids[slot] = 0;
+        if(entry.attacher_pids[slot] != 0)attachers_no++;
+    }
+    return attachers_no;
+}
+
+/**
+ * @brief Record an attachment of the calling process (the caller holds the lock).
+ *
+ * @return true If a slot was free, after reaping the dead attachers
+ */
+bool add_attacher(cache_registry_entry & entry){
+    if(reap_dead_attachers(entry) == SHARED_CACHE_MAX_ATTACHERS)return false;
+    for(int slot = 0; slot < SHARED_CACHE_MAX_ATTACHERS; slot++){
+        if(entry.attacher_pids[slot] == 0){
+            entry.attacher_pids[slot] = getpid();
+            return true;
+        }
+    }
+    return false;
+}
+
+void remove_attacher(cache_registry_entry & entry){
+    int pid = getpid();
+    for(int slot = 0; slot < SHARED_CACHE_MAX_ATTACHERS; slot++){
+        if(entry.attacher_pids[slot] == pid){
+            entry.attacher_pids[slot] = 0;
+            return;
+        }
+    }
+}
+
+/**
+ * @brief Remove an entry and its segment (the caller holds the lock).
+ */
+void evict_cache_entry(cache_registry * registry, int entry_id){
+    char name[64];
+    cache_segment_name(registry->entries[entry_id].key, name);
+    shm_unlink(name);
+    memset(&registry->entries[entry_id], 0, sizeof(cache_registry_entry));
+}
+
+/**
+ * @brief Make room for bytes more bytes and a free entry, evicting the least recently used
+ * systems that no live process uses (the caller holds the lock).
+ *
+ * @return int The free entry, or -1 if the system can not fit in the budget
+ */
+int reserve_cache_entry(cache_registry * registry, long long bytes, long long memory_budget){
+    while(true){
+        long long used_bytes = 0;
+        int free_entry = -1;
+        int victim = -1;
+        for(int entry_id = 0; entry_id < SHARED_CACHE_MAX_ENTRIES; entry_id++){
+            cache_registry_entry & entry = registry->entries[entry_id];
+            if(entry.key == 0){
+                if(free_entry < 0)free_entry = entry_id;
+                continue;
+            }
+            used_bytes += entry.bytes;
+            if(entry.ready && reap_dead_attachers(entry) == 0 && (victim < 0 || entry.last_used < registry->entries[victim].last_used))victim = entry_id;
+        }
+        if(free_entry >= 0 && used_bytes + bytes <= memory_budget)return free_entry;
+        if(victim < 0)return -1;
+        evict_cache_entry(registry, victim);
+    }
+}
+
+/**
+ * @brief Map a published segment and build the row pointers into its packed triangle.
+ */
+shared_matrix_handle map_cache_segment(unsigned long long key, int entry_id, int n, int protection){
+    shared_matrix_handle handle;
+    handle.entry_id = entry_id;
+    handle.key = key;
+    handle.unknowns_no = n;
+    handle.mapping_bytes = cache_segment_bytes(n);
+    handle.mapping = NULL;
+    handle.system.unknowns_no = 0;
+    handle.system.coefficients = NULL;
+    handle.system.free_terms = NULL;
+
+    char name[64];
+    cache_segment_name(key, name);
+    int descriptor = shm_open(name, (protection & PROT_WRITE) ? O_CREAT | O_TRUNC | O_RDWR : O_RDONLY, 0666);
+    if(descriptor < 0)return handle;
+    if((protection & PROT_WRITE) && ftruncate(descriptor, handle.mapping_bytes) != 0){
+        close(descriptor);
+        return handle;
+    }
+    void * mapping = mmap(NULL, handle.mapping_bytes, protection, MAP_SHARED, descriptor, 0);
+    close(descriptor);
+    if(mapping == MAP_FAILED)return handle;
+
+    handle.mapping = mapping;
+    handle.system.unknowns_no = n;
+    handle.system.free_terms = (double *)mapping;
+    double * packed = handle.system.free_terms + n;
+    handle.system.coefficients = new double*[n];
+    for(int row_id = 0; row_id < n; row_id++)handle.system.coefficients[row_id] = packed + cache_packed_row_offset(row_id, n) - row_id;
+    return handle;
+}
+
+shared_matrix_handle read_private_system(char * coeff_filename, char * free_terms_filename, int unknowns_no){
+    shared_matrix_handle handle;
+    handle.system = read_linear_system(coeff_filename, free_terms_filename, unknowns_no);
+    handle.entry_id = -1;
+    handle.key = 0;
+    handle.unknowns_no = unknowns_no;
+    handle.mapping = NULL;
+    handle.mapping_bytes = 0;
+    return handle;
+}
+
+/**
+ * @brief Get a system from the cache shared by the processes of this host, keyed by the contents
+ * of its input files. The first process to ask for a system parses it (with the conventions of
+ * read_linear_system) into a new named segment; the others attach it read-only. Systems no
+ * process uses stay cached until they are evicted (least recently used first) to keep the cache
+ * within memory_budget.
+ *
+ * @param coeff_filename The name of the file that stores the coefficient matrix
+ * @param free_terms_filename The name of the file that stores the free terms
+ * @param unknowns_no The number of unknowns
+ * @param memory_budget The limit on the memory of all the cached systems, in bytes
+ * @return shared_matrix_handle The system; release it with detach_shared_matrix
+ */
+shared_matrix_handle attach_shared_matrix(char * coeff_filename, char * free_terms_filename, int unknowns_no, long long memory_budget){
+    cache_registry * registry = open_cache_registry();
+    if(registry == NULL)return read_private_system(coeff_filename, free_terms_filename, unknowns_no);
+    unsigned long long key = hash_input_files(coeff_filename, free_terms_filename, unknowns_no);
+    if(key == 0)key = 1;
+    long long bytes = cache_segment_bytes(unknowns_no);
+
+    while(true){
+        lock_cache_registry(registry);
+        int entry_id = -1;
+        for(int i = 0; i < SHARED_CACHE_MAX_ENTRIES; i++){
+            if(registry->entries[i].key == key && registry->entries[i].unknowns_no == unknowns_no)entry_id = i;
+        }
+        if(entry_id >= 0 && registry->entries[entry_id].ready){
+            if(!add_attacher(registry->entries[entry_id])){
+                pthread_mutex_unlock(&registry->mutex);
+                munmap(registry, sizeof(cache_registry));
+                return read_private_system(coeff_filename, free_terms_filename, unknowns_no);
+            }
+            registry->entries[entry_id].last_used = ++registry->clock;
+            pthread_mutex_unlock(&registry->mutex);
+            munmap(registry, sizeof(cache_registry));
+            shared_matrix_handle handle = map_cache_segment(key, entry_id, unknowns_no, PROT_READ);
+            if(handle.mapping != NULL)return handle;
+            detach_shared_matrix(handle);
+            return read_private_system(coeff_filename, free_terms_filename, unknowns_no);
+        }
+        if(entry_id >= 0){
+            /* Another process is parsing it; take over if that process is gone: */
+            if(process_is_gone(registry->entries[entry_id].loader_pid))evict_cache_entry(registry, entry_id);
+            pthread_mutex_unlock(&registry->mutex);
+            usleep(1000);
+            continue;
+        }
+
+        entry_id = reserve_cache_entry(registry, bytes, memory_budget);
+        if(entry_id < 0){
+            pthread_mutex_unlock(&registry->mutex);
+            munmap(registry, sizeof(cache_registry));
+            return read_private_system(coeff_filename, free_terms_filename, unknowns_no);
+        }
+        cache_registry_entry & entry = registry->entries[entry_id];
+        memset(&entry, 0, sizeof(cache_registry_entry));
+        entry.key = key;
+        entry.bytes = bytes;
+        entry.unknowns_no = unknowns_no;
+        entry.attacher_pids[0] = getpid();
+        entry.ready = 0;
+        entry.loader_pid = getpid();
+        entry.last_used = ++registry->clock;
+        pthread_mutex_unlock(&registry->mutex);
+
+        /* Parse outside of the lock, then publish: */
+        shared_matrix_handle handle = map_cache_segment(key, entry_id, unknowns_no, PROT_READ | PROT_WRITE);
+        if(handle.mapping == NULL){
+            lock_cache_registry(registry);
+            evict_cache_entry(registry, entry_id);
+            pthread_mutex_unlock(&registry->mutex);
+            munmap(registry, sizeof(cache_registry));
+            return read_private_system(coeff_filename, free_terms_filename, unknowns_no);
+        }
+        linear_system_of_equations parsed = read_linear_system(coeff_filename, free_terms_filename, unknowns_no);
+        for(int row_id = 0; row_id < unknowns_no; row_id++){
+            handle.system.free_terms[row_id] = parsed.free_terms[row_id];
+            memcpy(handle.system.coefficients[row_id] + row_id, parsed.coefficients[row_id] + row_id, sizeof(double) * (unknowns_no - row_id));
+            delete[] parsed.coefficients[row_id];
+        }
+        delete[] parsed.coefficients;
+        delete[] parsed.free_terms;
+        mprotect(handle.mapping, handle.mapping_bytes, PROT_READ);
+
+        /* Unless the cache was cleared meanwhile: */
+        lock_cache_registry(registry);
+        if(entry.key == key && entry.unknowns_no == unknowns_no)entry.ready = 1;
+        pthread_mutex_unlock(&registry->mutex);
+        munmap(registry, sizeof(cache_registry));
+        return handle;
+    }
+}
+
+/**
+ * @brief Release a system got from attach_shared_matrix. A cached system stays in the cache.
+ * The attachment is only removed if the entry still holds the same system: after a
+ * clear_shared_matrix_cache, the entry may hold another one.
+ */
+void detach_shared_matrix(shared_matrix_handle handle){
+    if(handle.entry_id < 0){
+        for(int row_id = 0; row_id < handle.system.unknowns_no; row_id++)delete[] handle.system.coefficients[row_id];
+        delete[] handle.system.coefficients;
+        delete[] handle.system.free_terms;
+        return;
+    }
+    delete[] handle.system.coefficients;
+    if(handle.mapping != NULL)munmap(handle.mapping, handle.mapping_bytes);
+
+    cache_registry * registry = open_cache_registry();
+    if(registry == NULL)return;
+    lock_cache_registry(registry);
+    cache_registry_entry & entry = registry->entries[handle.entry_id];
+    if(entry.key == handle.key && entry.unknowns_no == handle.unknowns_no)remove_attacher(entry);
+    pthread_mutex_unlock(&registry->mutex);
+    munmap(registry, sizeof(cache_registry));
+}
+
+/**
+ * @brief Remove every cached system and the registry. The processes that still have a system
+ * attached keep their mapping.
+ */
+void clear_shared_matrix_cache(){
+    cache_registry * registry = open_cache_registry();
+    if(registry != NULL){
+        lock_cache_registry(registry);
+        for(int entry_id = 0; entry_id < SHARED_CACHE_MAX_ENTRIES; entry_id++){
+            if(registry->entries[entry_id].key != 0)evict_cache_entry(registry, entry_id);
+        }
+        pthread_mutex_unlock(&registry->mutex);
+        munmap(registry, sizeof(cache_registry));
+    }
+    shm_unlink(SHARED_CACHE_REGISTRY_NAME);
+}
@@ -0,0 +1,39 @@
+#include "linear_system_schema.h"
+
+#ifndef SHARED_MATRIX_CACHE_H
+#define SHARED_MATRIX_CACHE_H
+
+/* The shared memory segment that lists the cached systems (renamed whenever its layout changes): */
+#define SHARED_CACHE_REGISTRY_NAME "/triangular_solver_cache_2"
+/* The prefix of the segments that hold the systems (followed by the hash of the input files): */
+#define SHARED_CACHE_SEGMENT_PREFIX "/triangular_solver_"
+#define SHARED_CACHE_MAX_ENTRIES 64
+/* The number of attachments of one system that are tracked; more are read privately: */
+#define SHARED_CACHE_MAX_ATTACHERS 32
+/* The default limit on the memory of all the cached systems together: */
+#define SHARED_CACHE_MEMORY_BUDGET (1LL << 30)
+
+/**
+ * @brief A system attached from the cache. system.coefficients[row_id] points into the packed,
+ * read-only upper triangle so that system.coefficients[row_id][col_id] is valid for col_id >= row_id
+ * only; the solvers never read below the diagonal nor write the system.
+ * When the system does not fit in the budget, it is read privately (entry_id is -1) and the
+ * rows are the usual full rows. key and unknowns_no identify the entry, which may have been
+ * evicted and reused by the time the handle is detached.
+ */
+struct shared_matrix_handle {
+    linear_system_of_equations system;
+    int entry_id;
+    unsigned long long key;
+    int unknowns_no;
+    void *mapping;
+    long long mapping_bytes;
+};
+
+shared_matrix_handle attach_shared_matrix(char * coeff_filename, char * free_terms_filename, int unknowns_no, long long memory_budget);
+
+void detach_shared_matrix(shared_matrix_handle handle);
+
+void clear_shared_matrix_cache();
+
+#endif
@@ -0,0 +1,152 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+
+#include <chrono>
+#include <vector>
+
+#include "linear_system_schema.h"
+#include "block_inverse_solver.h"
+#include "triangular_solver.h"
+#include "solver_library.h"
+
+#define NUM_THREADS 40
+/* The two modes of make_solver are compared on the best of this many runs: */
+#define MODE_BENCHMARK_RUNS 5
+
+/**
+ * @brief Generate a random upper triangular system, with the same values as generate_system,
+ * except for the diagonal, which is made dominant so that the solutions of the different
+ * solvers can be compared with each other.
+ *
+ * @param n The number of unknowns
+ * @return linear_system_of_equations The generated system
+ */
+linear_system_of_equations generate_benchmark_system(int n){
+    linear_system_of_equations result;
+    result.coefficients = new double*[n];
+    result.free_terms = new double[n];
+    for(int row = 0; row < n; row++){
+        result.coefficients[row] = new double[n];
+        for(int col = 0; col < n; col++){
+            if(col > row)result.coefficients[row][col] = rand() * 0.1;
+            else result.coefficients[row][col] = 0.0;
+        }
+        result.coefficients[row][row] = (rand() + (double)RAND_MAX * n) * 0.1;
+        result.free_terms[row] = rand() * 0.1;
+    }
+    result.unknowns_no = n;
+    return result;
+}
+
+void free_benchmark_system(linear_system_of_equations lse){
+    for(int row = 0; row < lse.unknowns_no; row++)delete[] lse.coefficients[row];
+    delete[] lse.coefficients;
+    delete[] lse.free_terms;
+}
+
+/**
+ * @brief The reference: the plain back-substitution, without any logging.
+ */
+double * back_substitution(linear_system_of_equations lse){
+    int n = lse.unknowns_no;
+    double * result = new double[n];
+    for(int sol_id = n - 1; sol_id > -1; sol_id--){
+        double sum = lse.free_terms[sol_id];
+        for(int j = sol_id + 1; j < n; j++)sum -= lse.coefficients[sol_id][j] * result[j];
+        result[sol_id] = sum / lse.coefficients[sol_id][sol_id];
+    }
+    return result;
+}
+
+double elapsed_ms(std::chrono::high_resolution_clock::time_point begin){
+    std::chrono::high_resolution_clock::time_point end = std::chrono::high_resolution_clock::now();
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(end - begin).count() * 1e-6;
+}
+
+double max_relative_difference(double * solution, double * reference, int n){
+    double result = 0.0;
+    for(int i = 0; i < n; i++){
+        double difference = fabs(solution[i] - reference[i]) / (fabs(reference[i]) + 1e-300);
+        if(difference > result)result = difference;
+    }
+    return result;
+}
+
+void report(const char * solver_name, double time_ms, double * solution, double * reference, int n){
+    printf("%-32s %12.3f ms   max relative difference = %e\n", solver_name, time_ms, max_relative_difference(solution, reference, n));
+}
+
+/**
+ * @brief The best time of MODE_BENCHMARK_RUNS solves, in ms; the solution of the last one goes to solution.
+ */
+double best_solve_ms(const Solver & solver, const TriangularSystem & system, std::vector<double> & solution){
+    double best_ms = 1e30;
+    for(int run = 0; run < MODE_BENCHMARK_RUNS; run++){
+        std::chrono::high_resolution_clock::time_point begin = std::chrono::high_resolution_clock::now();
+        solution = solver.solve(system);
+        double ms = elapsed_ms(begin);
+        if(ms < best_ms)best_ms = ms;
+    }
+    return best_ms;
+}
+
+/**
+ * @brief The cost of REPRODUCIBLE_MODE: every back-end of make_solver that has a reproducible
+ * variant, in both modes, with NUM_THREADS threads; then whether the reproducible results are the
+ * same bits for every back-end and for one thread.
+ */
+void compare_solve_modes(linear_system_of_equations lse){
+    TriangularSystem system(lse);
+    const char * backend_names[] = {"sequential", "open_mp", "recursive", "row_pull"};
+    solver_backend backends[] = {SEQUENTIAL_BACKEND, OPEN_MP_BACKEND, RECURSIVE_BACKEND, ROW_PULL_BACKEND};
+    /* What make_solver runs in REPRODUCIBLE_MODE (see solve_mode): */
+    const char * reproducible_names[] = {"ReproducibleSolver(1)", "ReproducibleSolver", "ReproducibleRecursiveSolver", "ReproducibleSolver"};
+    std::vector<double> solution;
+    std::vector<double> single_thread = make_solver(SEQUENTIAL_BACKEND, 1, 0, REPRODUCIBLE_MODE)->solve(system);
+    bool identical = true;
+
+    printf("    %-12s %12s %15s %8s   %s\n", "make_solver", "fast (ms)", "reproducible", "cost", "reproducible solver");
+    for(int backend_id = 0; backend_id < 4; backend_id++){
+        double fast_ms = best_solve_ms(*make_solver(backends[backend_id], NUM_THREADS, 0, FAST_MODE), system, solution);
+        double reproducible_ms = best_solve_ms(*make_solver(backends[backend_id], NUM_THREADS, 0, REPRODUCIBLE_MODE), system, solution);
+        if(solution != single_thread)identical = false;
+        printf("    %-12s %12.3f %15.3f %7.2fx   %s\n", backend_names[backend_id], fast_ms, reproducible_ms, reproducible_ms / fast_ms, reproducible_names[backend_id]);
+    }
+    printf("    (reproducible results bitwise identical across thread counts and back-ends: %s)\n", identical ? "yes" : "no");
+}
+
+void run_benchmark(int n){
+    printf("n = %d, threads = %d\n", n, NUM_THREADS);
+    linear_system_of_equations lse = generate_benchmark_system(n);
+
+    std::chrono::high_resolution_clock::time_point begin = std::chrono::high_resolution_clock::now();
+    double * reference = back_substitution(lse);
+    report("back_substitution", elapsed_ms(begin), reference, reference, n);
+
+    begin = std::chrono::high_resolution_clock::now();
+    block_inverse_system bis = prepare_block_inverse_system(lse, 0, NUM_THREADS);
+    double prepare_ms = elapsed_ms(begin);
+    begin = std::chrono::high_resolution_clock::now();
+    double * solution = block_inverse_solver(&bis, NUM_THREADS);
+    report("block_inverse_solver", elapsed_ms(begin), solution, reference, n);
+    printf("    (block size %d, inverting the blocks took %.3f ms)\n", bis.block_size, prepare_ms);
+    free_block_inverse_system(bis);
+    delete[] solution;
+
+    begin = std::chrono::high_resolution_clock::now();
+    solution = triangular_system_solver(lse, UPPER_TRIANGLE, NO_TRANSPOSE, NON_UNIT_DIAGONAL, NUM_THREADS);
+    report("triangular_system_solver", elapsed_ms(begin), solution, reference, n);
+    delete[] solution;
+
+    delete[] reference;
+    compare_solve_modes(lse);
+    free_benchmark_system(lse);
+}
+
+int main(){
+    srand(0);
+    int sizes[] = {100, 1000, 4000};
+    for(int size_id = 0; size_id < 3; size_id++)run_benchmark(sizes[size_id]);
+    return 0;
+}
@@ -0,0 +1,427 @@
+#include "solver_library.h"
+#include "open_mp_solver.h"
+#include "recursive_solver.h"
+#include "block_inverse_solver.h"
+#include "mixed_precision_solver.h"
+#include "triangular_solver.h"
+#include "compensated_solver.h"
+#include "reproducible_solver.h"
+#include "row_oriented_solver.h"
+#include "parallel_equation_solver.h"
+#include <fstream>
+#include <functional>
+#include <math.h>
+
+TriangularSystem::TriangularSystem(int unknowns_no){
+    unknowns_no_ = unknowns_no;
+    coefficients_ = new double*[unknowns_no];
+    free_terms_ = new double[unknowns_no];
+    for(int row_id = 0; row_id < unknowns_no; row_id++){
+        coefficients_[row_id] = new double[unknowns_no];
+        for(int col_id = 0; col_id < unknowns_no; col_id++)coefficients_[row_id][col_id] = 0.0;
+        free_terms_[row_id] = 0.0;
+    }
+}
+
+TriangularSystem::TriangularSystem(const linear_system_of_equations & lse){
+    unknowns_no_ = lse.unknowns_no;
+    coefficients_ = new double*[unknowns_no_];
+    free_terms_ = new double[unknowns_no_];
+    for(int row_id = 0; row_id < unknowns_no_; row_id++){
+        coefficients_[row_id] = new double[unknowns_no_];
+        for(int col_id = 0; col_id < unknowns_no_; col_id++)
+            coefficients_[row_id][col_id] = (col_id >= row_id) ? lse.coefficients[row_id][col_id] : 0.0;
+        free_terms_[row_id] = lse.free_terms[row_id];
+    }
+}
+
+TriangularSystem::TriangularSystem(TriangularSystem && other){
+    coefficients_ = other.coefficients_;
+    free_terms_ = other.free_terms_;
+    unknowns_no_ = other.unknowns_no_;
+    other.coefficients_ = 0;
+    other.free_terms_ = 0;
+    other.unknowns_no_ = 0;
+}
+
+TriangularSystem & TriangularSystem::operator=(TriangularSystem && other){
+    if(this != &other){
+        release();
+        coefficients_ = other.coefficients_;
+        free_terms_ = other.free_terms_;
+        unknowns_no_ = other.unknowns_no_;
+        other.coefficients_ = 0;
+        other.free_terms_ = 0;
+        other.unknowns_no_ = 0;
+    }
+    return *this;
+}
+
+TriangularSystem::~TriangularSystem(){
+    release();
+}
+
+void TriangularSystem::release(){
+    if(coefficients_ != 0){
+        for(int row_id = 0; row_id < unknowns_no_; row_id++)delete[] coefficients_[row_id];
+        delete[] coefficients_;
+    }
+    delete[] free_terms_;
+    coefficients_ = 0;
+    free_terms_ = 0;
+}
+
+/**
+ * @brief Read the number of unknowns from its file (0 if it cannot be read).
+ */
+int read_unknowns_no(const char * unknown_no_filename){
+    int result = 0;
+    std::ifstream unknowns_no_file(unknown_no_filename);
+    unknowns_no_file >> result;
+    unknowns_no_file.close();
+    return result;
+}
+
+/**
+ * @brief The value of a coefficient stored as value in a file, with the given value convention
+ * (for the readers of binary files, which do not parse text).
+ */
+double convert_coefficient(double value, coefficient_convention convention){
+    if(convention == READER_CONVENTION){
+        value = value * 0.01;
+        if(value == 0)value = 1.0;
+    }
+    return value;
+}
+
+/**
+ * @brief Read the next coefficient of a coefficient file, with the given value convention.
+ */
+double read_coefficient(std::istream & coeff_file, coefficient_convention convention){
+    double value = 0.0;
+    coeff_file >> value;
+    return convert_coefficient(value, convention);
+}
+
+/**
+ * @brief Read the next free term of a free terms file, with the given value convention.
+ */
+double read_free_term(std::istream & free_terms_file, coefficient_convention convention){
+    double value = 0.0;
+    free_terms_file >> value;
+    if(convention == READER_CONVENTION && value == 0)value = 1000.0;
+    return value;
+}
+
+/**
+ * @brief Read a system in the usual text format (the number of unknowns, the n - i coefficients
+ * of the upper triangle on row i, and the free terms).
+ *
+ * @param coeff_filename The name of the file that stores the coefficient matrix
+ * @param free_terms_filename The name of the file that stores the free terms
+ * @param unknown_no_filename The name of the file that stores the number of unknowns
+ * @param convention How the values are read: like the assignment programs (the default), or raw
+ * @return TriangularSystem The system
+ */
+TriangularSystem TriangularSystem::read(const char * coeff_filename, const char * free_terms_filename, const char * unknown_no_filename,
+                                        coefficient_convention convention){
+    int n = read_unknowns_no(unknown_no_filename);
+
+    TriangularSystem result(n);
+    std::ifstream coeff_file(coeff_filename);
+    for(int row_id = 0; row_id < n; row_id++){
+        for(int col_id = row_id; col_id < n; col_id++)result.coefficients_[row_id][col_id] = read_coefficient(coeff_file, convention);
+    }
+    coeff_file.close();
+
+    std::ifstream free_terms_file(free_terms_filename);
+    for(int eq_id = 0; eq_id < n; eq_id++)result.free_terms_[eq_id] = read_free_term(free_terms_file, convention);
+    free_terms_file.close();
+    return result;
+}
+
+linear_system_of_equations TriangularSystem::view() const {
+    linear_system_of_equations result;
+    result.coefficients = coefficients_;
+    result.free_terms = free_terms_;
+    result.unknowns_no = unknowns_no_;
+    return result;
+}
+
+std::vector<double> Solver::solve(const TriangularSystem & system) const {
+    double * solution = solve_system(system.view());
+    std::vector<double> result(solution, solution + system.unknowns_no());
+    delete[] solution;
+    return result;
+}
+
+/**
+ * @brief Solve the right hand sides one column at a time: every column is copied into the array
+ * *column_slot points to, then solve_column returns its solution (allocated with new[]).
+ */
+std::vector<double> solve_columns(int n, const std::vector<double> & free_terms, int rhs_no, double ** column_slot, std::function<double * ()> solve_column){
+    std::vector<double> result((long long)n * rhs_no);
+    double * column = new double[n];
+    *column_slot = column;
+    for(int rhs_id = 0; rhs_id < rhs_no; rhs_id++){
+        for(int row_id = 0; row_id < n; row_id++)column[row_id] = free_terms[(long long)row_id * rhs_no + rhs_id];
+        double * solution = solve_column();
+        for(int row_id = 0; row_id < n; row_id++)result[(long long)row_id * rhs_no + rhs_id] = solution[row_id];
+        delete[] solution;
+    }
+    delete[] column;
+    return result;
+}
+
+/**
+ * @brief The default for several right hand sides: one solve per right hand side, through views
+ * of the system that only differ by their free terms.
+ */
+std::vector<double> Solver::solve_multiple(const TriangularSystem & system, const std::vector<double> & free_terms, int rhs_no) const {
+    linear_system_of_equations lse = system.view();
+    return solve_columns(system.unknowns_no(), free_terms, rhs_no, &lse.free_terms, [&lse, this]() { return solve_system(lse); });
+}
+
+std::future<std::vector<double> > Solver::solve_async(const TriangularSystem & system) const {
+    const Solver * solver = this;
+    const TriangularSystem * solved_system = &system;
+    return std::async(std::launch::async, [solver, solved_system]() { return solver->solve(*solved_system); });
+}
+
+/* The back-ends. The sequential one uses the blocked kernel, since sequential_system_solver
+ * writes a trace file. */
+
+class SequentialSolver : public Solver {
+public:
+    double * solve_system(linear_system_of_equations lse) const {
+        return triangular_system_solver(lse, UPPER_TRIANGLE, NO_TRANSPOSE, NON_UNIT_DIAGONAL, 1);
+    }
+};
+
+class OpenMpSolver : public Solver {
+public:
+    explicit OpenMpSolver(int number_of_threads) : number_of_threads_(number_of_threads) {}
+    double * solve_system(linear_system_of_equations lse) const {
+        return open_mp_parallel_solver(lse, number_of_threads_);
+    }
+private:
+    int number_of_threads_;
+};
+
+class RecursiveSolver : public Solver {
+public:
+    explicit RecursiveSolver(int number_of_threads) : number_of_threads_(number_of_threads) {}
+    double * solve_system(linear_system_of_equations lse) const {
+        return recursive_system_solver(lse, number_of_threads_);
+    }
+    /* All the right hand sides at once: the rectangle updates become matrix-matrix products. */
+    std::vector<double> solve_multiple(const TriangularSystem & system, const std::vector<double> & free_terms, int rhs_no) const {
+        long long size = (long long)system.unknowns_no() * rhs_no;
+        double * solution = recursive_multiple_rhs_solver(system.view(), const_cast<double *>(free_terms.data()), rhs_no, number_of_threads_);
+        std::vector<double> result(solution, solution + size);
+        delete[] solution;
+        return result;
+    }
+private:
+    int number_of_threads_;
+};
+
+class BlockInverseSolver : public Solver {
+public:
+    BlockInverseSolver(int number_of_threads, int block_size) : number_of_threads_(number_of_threads), block_size_(block_size) {}
+    double * solve_system(linear_system_of_equations lse) const {
+        block_inverse_system bis = prepare_block_inverse_system(lse, block_size_, number_of_threads_);
+        double * solution = block_inverse_solver(&bis, number_of_threads_);
+        free_block_inverse_system(bis);
+        return solution;
+    }
+    /* The block inverses are computed once for all the right hand sides: */
+    std::vector<double> solve_multiple(const TriangularSystem & system, const std::vector<double> & free_terms, int rhs_no) const {
+        block_inverse_system bis = prepare_block_inverse_system(system.view(), block_size_, number_of_threads_);
+        std::vector<double> result = solve_columns(system.unknowns_no(), free_terms, rhs_no, &bis.lse.free_terms,
+                                                   [&bis, this]() { return block_inverse_solver(&bis, number_of_threads_); });
+        free_block_inverse_system(bis);
+        return result;
+    }
+private:
+    int number_of_threads_;
+    int block_size_;
+};
+
+class MixedPrecisionSolver : public Solver {
+public:
+    explicit MixedPrecisionSolver(int number_of_threads) : number_of_threads_(number_of_threads) {}
+    double * solve_system(linear_system_of_equations lse) const {
+        int refinement_steps = 0;
+        return mixed_precision_open_mp_solver(lse, number_of_threads_, &refinement_steps);
+    }
+    /* The float copy of the matrix is packed once for all the right hand sides: */
+    std::vector<double> solve_multiple(const TriangularSystem & system, const std::vector<double> & free_terms, int rhs_no) const {
+        mixed_precision_system mps = prepare_mixed_precision_system(system.view());
+        int refinement_steps = 0;
+        std::vector<double> result = solve_columns(system.unknowns_no(), free_terms, rhs_no, &mps.lse.free_terms,
+                                                   [&mps, &refinement_steps, this]() { return mixed_precision_prepared_solver(&mps, number_of_threads_, &refinement_steps); });
+        free_mixed_precision_system(mps);
+        return result;
+    }
+private:
+    int number_of_threads_;
+};
+
+/* The sequential, OpenMP and recursive back-ends in the fixed order of the reproducible mode: */
+
+class ReproducibleSolver : public Solver {
+public:
+    explicit ReproducibleSolver(int number_of_threads) : number_of_threads_(number_of_threads) {}
+    double * solve_system(linear_system_of_equations lse) const {
+        return reproducible_system_solver(lse, number_of_threads_);
+    }
+private:
+    int number_of_threads_;
+};
+
+class ReproducibleRecursiveSolver : public Solver {
+public:
+    explicit ReproducibleRecursiveSolver(int number_of_threads) : number_of_threads_(number_of_threads) {}
+    double * solve_system(linear_system_of_equations lse) const {
+        return recursive_reproducible_solver(lse, number_of_threads_);
+    }
+private:
+    int number_of_threads_;
+};
+
+class CompensatedSolver : public Solver {
+public:
+    explicit CompensatedSolver(int number_of_threads) : number_of_threads_(number_of_threads) {}
+    double * solve_system(linear_system_of_equations lse) const {
+        return compensated_system_solver(lse, number_of_threads_);
+    }
+private:
+    int number_of_threads_;
+};
+
+class RowPullSolver : public Solver {
+public:
+    explicit RowPullSolver(int number_of_threads) : number_of_threads_(number_of_threads) {}
+    double * solve_system(linear_system_of_equations lse) const {
+        return row_pull_solver(lse, number_of_threads_);
+    }
+private:
+    int number_of_threads_;
+};
+
+class HybridSolver : public Solver {
+public:
+    HybridSolver(int number_of_threads, int block_size, hybrid_update update) : number_of_threads_(number_of_threads), block_size_(block_size), update_(update) {}
+    double * solve_system(linear_system_of_equations lse) const {
+        return blocked_hybrid_solver(lse, number_of_threads_, block_size_, update_);
+    }
+private:
+    int number_of_threads_;
+    int block_size_;
+    hybrid_update update_;
+};
+
+class ThreadsSolver : public Solver {
+public:
+    explicit ThreadsSolver(int number_of_threads) : number_of_threads_(number_of_threads) {}
+    double * solve_system(linear_system_of_equations lse) const {
+        return parallel_system_solver(lse, number_of_threads_);
+    }
+private:
+    int number_of_threads_;
+};
+
+/**
+ * @brief Create a solver for the chosen back-end.
+ *
+ * @param backend The back-end
+ * @param number_of_threads The number of threads used by the parallel back-ends
+ * @param block_size The block size of the back-ends that have one (0 lets them choose)
+ * @param mode FAST_MODE, or REPRODUCIBLE_MODE for results that do not depend on the number of threads
+ * @return std::unique_ptr<Solver> The solver
+ */
+std::unique_ptr<Solver> make_solver(solver_backend backend, int number_of_threads, int block_size, solve_mode mode){
+    if(mode == REPRODUCIBLE_MODE){
+        if(backend == SEQUENTIAL_BACKEND)return std::unique_ptr<Solver>(new ReproducibleSolver(1));
+        if(backend == OPEN_MP_BACKEND)return std::unique_ptr<Solver>(new ReproducibleSolver(number_of_threads));
+        if(backend == RECURSIVE_BACKEND)return std::unique_ptr<Solver>(new ReproducibleRecursiveSolver(number_of_threads));
+        if(backend == ROW_PULL_BACKEND)return std::unique_ptr<Solver>(new ReproducibleSolver(number_of_threads));
+    }
+    switch(backend){
+        case OPEN_MP_BACKEND: return std::unique_ptr<Solver>(new OpenMpSolver(number_of_threads));
+        case RECURSIVE_BACKEND: return std::unique_ptr<Solver>(new RecursiveSolver(number_of_threads));
+        case BLOCK_INVERSE_BACKEND: return std::unique_ptr<Solver>(new BlockInverseSolver(number_of_threads, block_size));
+        case MIXED_PRECISION_BACKEND: return std::unique_ptr<Solver>(new MixedPrecisionSolver(number_of_threads));
+        case COMPENSATED_BACKEND: return std::unique_ptr<Solver>(new CompensatedSolver(number_of_threads));
+        case ROW_PULL_BACKEND: return std::unique_ptr<Solver>(new RowPullSolver(number_of_threads));
+        case HYBRID_PUSH_BACKEND: return std::unique_ptr<Solver>(new HybridSolver(number_of_threads, block_size, PUSH_BLOCKS));
+        case HYBRID_PULL_BACKEND: return std::unique_ptr<Solver>(new HybridSolver(number_of_threads, block_size, PULL_BLOCKS));
+        case THREADS_BACKEND: return std::unique_ptr<Solver>(new ThreadsSolver(number_of_threads));
+        default: return std::unique_ptr<Solver>(new SequentialSolver());
+    }
+}
+
+/**
+ * @brief Find the configuration to use for a problem: among the entries of the goal, the entry
+ * with the closest number of right hand sides, then, among those, the closest size (on a
+ * logarithmic scale). A table without entries of the goal (written before THROUGHPUT_GOAL
+ * existed) falls back to the LATENCY_GOAL ones; an empty table gives the sequential back-end.
+ *
+ * @param table The tuning table (see auto_tuner.h)
+ * @param unknowns_no The number of unknowns of the problem
+ * @param rhs_no The number of right hand sides of the problem
+ * @param goal LATENCY_GOAL or THROUGHPUT_GOAL
+ * @return tuning_entry The chosen configuration
+ */
+tuning_entry choose_tuning_entry(const std::vector<tuning_entry> & table, int unknowns_no, int rhs_no, tuning_goal goal){
+    tuning_entry result;
+    result.unknowns_no = unknowns_no;
+    result.rhs_no = rhs_no;
+    result.backend = SEQUENTIAL_BACKEND;
+    result.number_of_threads = 1;
+    result.block_size = 0;
+    result.seconds = 0.0;
+    result.goal = goal;
+
+    bool goal_found = false;
+    for(size_t entry_id = 0; entry_id < table.size(); entry_id++)if(table[entry_id].goal == goal)goal_found = true;
+    if(!goal_found)goal = LATENCY_GOAL;
+
+    double best_rhs_distance = 1e300;
+    double best_size_distance = 1e300;
+    for(size_t entry_id = 0; entry_id < table.size(); entry_id++){
+        if(table[entry_id].goal != goal)continue;
+        double rhs_distance = fabs(log((double)table[entry_id].rhs_no / rhs_no));
+        double size_distance = fabs(log((double)table[entry_id].unknowns_no / unknowns_no));
+        if(rhs_distance < best_rhs_distance || (rhs_distance == best_rhs_distance && size_distance < best_size_distance)){
+            best_rhs_distance = rhs_distance;
+            best_size_distance = size_distance;
+            result = table[entry_id];
+        }
+    }
+    return result;
+}
+
+/**
+ * @brief A solver that picks, for every system, the back-end, thread count and block size the
+ * tuning table found fastest for its size.
+ */
+class TunedSolver : public Solver {
+public:
+    explicit TunedSolver(const std::vector<tuning_entry> & table) : table_(table) {}
+    double * solve_system(linear_system_of_equations lse) const {
+        tuning_entry entry = choose_tuning_entry(table_, lse.unknowns_no, 1);
+        return make_solver(entry.backend, entry.number_of_threads, entry.block_size)->solve_system(lse);
+    }
+    std::vector<double> solve_multiple(const TriangularSystem & system, const std::vector<double> & free_terms, int rhs_no) const {
+        tuning_entry entry = choose_tuning_entry(table_, system.unknowns_no(), rhs_no);
+        return make_solver(entry.backend, entry.number_of_threads, entry.block_size)->solve_multiple(system, free_terms, rhs_no);
+    }
+private:
+    std::vector<tuning_entry> table_;
+};
+
+std::unique_ptr<Solver> make_tuned_solver(const std::vector<tuning_entry> & table){
+    return std::unique_ptr<Solver>(new TunedSolver(table));
+}
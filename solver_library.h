@@ -0,0 +1,124 @@
+#include "linear_system_schema.h"
+
+#ifndef SOLVER_LIBRARY_H
+#define SOLVER_LIBRARY_H
+
+#include <future>
+#include <istream>
+#include <memory>
+#include <vector>
+
+/**
+ * @brief An upper triangular system that owns its coefficients and free terms.
+ * It can be moved, but not copied; the storage is released by the destructor.
+ */
+class TriangularSystem {
+public:
+    explicit TriangularSystem(int unknowns_no);
+    explicit TriangularSystem(const linear_system_of_equations & lse);
+    TriangularSystem(TriangularSystem && other);
+    TriangularSystem & operator=(TriangularSystem && other);
+    ~TriangularSystem();
+
+    static TriangularSystem read(const char * coeff_filename, const char * free_terms_filename, const char * unknown_no_filename,
+                                 coefficient_convention convention = READER_CONVENTION);
+
+    int unknowns_no() const { return unknowns_no_; }
+    double * row(int row_id) const { return coefficients_[row_id]; }
+    double * free_terms() const { return free_terms_; }
+
+    /* A non-owning view, for the functions that take a linear_system_of_equations: */
+    linear_system_of_equations view() const;
+
+private:
+    TriangularSystem(const TriangularSystem &);
+    TriangularSystem & operator=(const TriangularSystem &);
+    void release();
+
+    double **coefficients_;
+    double *free_terms_;
+    int unknowns_no_;
+};
+
+enum solver_backend {
+    SEQUENTIAL_BACKEND,
+    OPEN_MP_BACKEND,
+    RECURSIVE_BACKEND,
+    BLOCK_INVERSE_BACKEND,
+    MIXED_PRECISION_BACKEND,
+    COMPENSATED_BACKEND,
+    ROW_PULL_BACKEND,
+    HYBRID_PUSH_BACKEND,
+    HYBRID_PULL_BACKEND,
+    THREADS_BACKEND
+};
+
+/**
+ * @brief FAST_MODE lets every back-end use its fastest order of operations. In REPRODUCIBLE_MODE
+ * the results do not depend on the number of threads. make_solver replaces four back-ends with
+ * the solvers of reproducible_solver.h, which follow one fixed order of operations and give the
+ * same bits as each other:
+ * - SEQUENTIAL_BACKEND by ReproducibleSolver with one thread
+ * - OPEN_MP_BACKEND and ROW_PULL_BACKEND by ReproducibleSolver
+ * - RECURSIVE_BACKEND by ReproducibleRecursiveSolver
+ * The block inverse, mixed precision, compensated, hybrid and threads back-ends are not replaced:
+ * the order of their own arithmetic never depends on the number of threads, so each of them is
+ * reproducible on its own, but their bits differ from the other back-ends'.
+ */
+enum solve_mode { FAST_MODE, REPRODUCIBLE_MODE };
+
+/**
+ * @brief The common interface of the solver back-ends. A Solver holds no state that changes
+ * during a solve, so the same object can run several solves at the same time.
+ */
+class Solver {
+public:
+    virtual ~Solver() {}
+
+    std::vector<double> solve(const TriangularSystem & system) const;
+
+    /* free_terms holds rhs_no right hand sides per row (free_terms[row * rhs_no + rhs_id]); so does the result: */
+    virtual std::vector<double> solve_multiple(const TriangularSystem & system, const std::vector<double> & free_terms, int rhs_no) const;
+
+    /* The task of the future only holds pointers: the system (unchanged) and this solver must
+     * both stay alive until the future is ready: */
+    std::future<std::vector<double> > solve_async(const TriangularSystem & system) const;
+
+    /* Solve a system the caller owns; the result is allocated with new[]: */
+    virtual double * solve_system(linear_system_of_equations lse) const = 0;
+};
+
+/**
+ * @brief What a tuning entry was chosen for: LATENCY_GOAL is the fastest solve of one problem;
+ * THROUGHPUT_GOAL the fewest seconds x threads, for machines that run many solves at once.
+ */
+enum tuning_goal { LATENCY_GOAL, THROUGHPUT_GOAL };
+
+/**
+ * @brief One line of a tuning table: the best configuration measured for a problem size.
+ */
+struct tuning_entry {
+    int unknowns_no;
+    int rhs_no;
+    solver_backend backend;
+    int number_of_threads;
+    int block_size;
+    double seconds;
+    tuning_goal goal;
+};
+
+int read_unknowns_no(const char * unknown_no_filename);
+
+double convert_coefficient(double value, coefficient_convention convention);
+
+double read_coefficient(std::istream & coeff_file, coefficient_convention convention);
+
+double read_free_term(std::istream & free_terms_file, coefficient_convention convention);
+
+std::unique_ptr<Solver> make_solver(solver_backend backend, int number_of_threads, int block_size = 0, solve_mode mode = FAST_MODE);
+
+tuning_entry choose_tuning_entry(const std::vector<tuning_entry> & table, int unknowns_no, int rhs_no, tuning_goal goal = LATENCY_GOAL);
+
+std::unique_ptr<Solver> make_tuned_solver(const std::vector<tuning_entry> & table);
+
+#endif
@@ -0,0 +1,321 @@
+#include "sparse_solver.h"
+#include <fstream>
+#include <stdio.h>
+
+/* Below this average number of rows per level, the barriers cost more than the parallel work: */
+#define SPARSE_MIN_LEVEL_WIDTH 64
+
+/**
+ * @brief Whether (row_id, col_id) is on or above the diagonal of an n x n matrix.
+ */
+bool upper_entry_in_range(int row_id, int col_id, int n){
+    return row_id >= 0 && row_id < n && col_id >= row_id && col_id < n;
+}
+
+/**
+ * @brief Build the CSR arrays of a system from a list of (row, col, value) entries.
+ * Entries below the diagonal or outside the n x n matrix are ignored, the diagonal entries go
+ * to slse.diagonal.
+ *
+ * @param rows The row of every entry
+ * @param cols The column of every entry
+ * @param entry_values The value of every entry
+ * @param entries_no The number of entries
+ * @param n The number of unknowns
+ * @return sparse_linear_system_of_equations The system, without free terms and without level schedule
+ */
+sparse_linear_system_of_equations build_sparse_system(int * rows, int * cols, double * entry_values, int entries_no, int n){
+    sparse_linear_system_of_equations result;
+    result.unknowns_no = n;
+    result.row_start = new int[n + 1];
+    result.diagonal = new double[n];
+    result.free_terms = 0;
+    result.level_start = 0;
+    result.level_rows = 0;
+    result.levels_no = 0;
+
+    for(int row_id = 0; row_id <= n; row_id++)result.row_start[row_id] = 0;
+    for(int row_id = 0; row_id < n; row_id++)result.diagonal[row_id] = 0.0;
+
+    /* Count the strictly upper entries of every row, then turn the counts into offsets: */
+    for(int entry_id = 0; entry_id < entries_no; entry_id++){
+        if(!upper_entry_in_range(rows[entry_id], cols[entry_id], n))continue;
+        if(cols[entry_id] > rows[entry_id])result.row_start[rows[entry_id] + 1] += 1;
+    }
+    for(int row_id = 0; row_id < n; row_id++)result.row_start[row_id + 1] += result.row_start[row_id];
+    result.nonzeros_no = result.row_start[n];
+    result.col_index = new int[result.nonzeros_no];
+    result.values = new double[result.nonzeros_no];
+
+    int * next = new int[n];
+    for(int row_id = 0; row_id < n; row_id++)next[row_id] = result.row_start[row_id];
+    for(int entry_id = 0; entry_id < entries_no; entry_id++){
+        int row_id = rows[entry_id];
+        if(!upper_entry_in_range(row_id, cols[entry_id], n))continue;
+        if(cols[entry_id] == row_id)result.diagonal[row_id] += entry_values[entry_id];
+        else if(cols[entry_id] > row_id){
+            result.col_index[next[row_id]] = cols[entry_id];
+            result.values[next[row_id]] = entry_values[entry_id];
+            next[row_id] += 1;
+        }
+    }
+    delete[] next;
+    return result;
+}
+
+/**
+ * @brief Read a sparse upper triangular system. The coefficient file holds one
+ * "row col value" entry per line (0-based indices); the free terms and the number
+ * of unknowns have the same format as for the dense systems.
+ *
+ * @param coeff_filename The name of the file that stores the nonzero coefficients
+ * @param free_terms_filename The name of the file that stores the free terms
+ * @param unknown_no_filename The name of the file that stores the number of unknowns
+ * @return sparse_linear_system_of_equations The system, without level schedule (unknowns_no is 0
+ * and the arrays are null if a file is missing or holds an entry below the diagonal or outside
+ * the matrix)
+ */
+sparse_linear_system_of_equations read_sparse_linear_system(char * coeff_filename, char * free_terms_filename, char * unknown_no_filename){
+    sparse_linear_system_of_equations empty;
+    empty.row_start = 0;
+    empty.col_index = 0;
+    empty.values = 0;
+    empty.diagonal = 0;
+    empty.free_terms = 0;
+    empty.unknowns_no = 0;
+    empty.nonzeros_no = 0;
+    empty.level_start = 0;
+    empty.level_rows = 0;
+    empty.levels_no = 0;
+
+    int n = 0;
+    std::ifstream unknowns_no_file(unknown_no_filename);
+    if(!(unknowns_no_file >> n) || n < 1){
+        printf("Could not read the number of unknowns from %s\n", unknown_no_filename);
+        return empty;
+    }
+    unknowns_no_file.close();
+
+    int capacity = 1024;
+    int entries_no = 0;
+    int * rows = new int[capacity];
+    int * cols = new int[capacity];
+    double * entry_values = new double[capacity];
+
+    std::ifstream coeff_file(coeff_filename);
+    if(!coeff_file.is_open())printf("Could not open %s\n", coeff_filename);
+    bool valid = coeff_file.is_open();
+    int row_id, col_id;
+    double value;
+    while(valid && coeff_file >> row_id >> col_id >> value){
+        if(!upper_entry_in_range(row_id, col_id, n)){
+            printf("%s: entry (%d, %d) is not in the upper triangle of a %d x %d matrix\n", coeff_filename, row_id, col_id, n, n);
+            valid = false;
+            break;
+        }
+        if(entries_no == capacity){
+            int * new_rows = new int[2 * capacity];
+            int * new_cols = new int[2 * capacity];
+            double * new_values = new double[2 * capacity];
+            for(int i = 0; i < entries_no; i++){
+                new_rows[i] = rows[i];
+                new_cols[i] = cols[i];
+                new_values[i] = entry_values[i];
+            }
+            delete[] rows;
+            delete[] cols;
+            delete[] entry_values;
+            rows = new_rows;
+            cols = new_cols;
+            entry_values = new_values;
+            capacity *= 2;
+        }
+        rows[entries_no] = row_id;
+        cols[entries_no] = col_id;
+        entry_values[entries_no] = value;
+        entries_no += 1;
+    }
+    /* Stopping before the end of the file means an entry could not be parsed: */
+    if(valid && !coeff_file.eof()){
+        printf("%s: entry %d is not a \"row col value\" triple\n", coeff_filename, entries_no);
+        valid = false;
+    }
+    coeff_file.close();
+    if(!valid){
+        delete[] rows;
+        delete[] cols;
+        delete[] entry_values;
+        return empty;
+    }
+
+    sparse_linear_system_of_equations result = build_sparse_system(rows, cols, entry_values, entries_no, n);
+    delete[] rows;
+    delete[] cols;
+    delete[] entry_values;
+
+    std::ifstream free_terms_file(free_terms_filename);
+    result.free_terms = new double[n];
+    for(int eq_id = 0; eq_id < n; eq_id++){
+        if(!(free_terms_file >> result.free_terms[eq_id])){
+            printf("Could not read %d free terms from %s\n", n, free_terms_filename);
+            free_sparse_system(result);
+            return empty;
+        }
+    }
+    free_terms_file.close();
+
+    return result;
+}
+
+/**
+ * @brief Write the coefficients of a sparse system in the format of read_sparse_linear_system.
+ *
+ * @param slse The sparse system
+ * @param coeff_filename The name of the file to be generated
+ */
+void write_sparse_coefficient_matrix(sparse_linear_system_of_equations slse, char * coeff_filename){
+    std::ofstream coeff_file;
+    coeff_file.open(coeff_filename);
+    for(int row_id = 0; row_id < slse.unknowns_no; row_id++){
+        coeff_file << row_id << " " << row_id << " " << slse.diagonal[row_id] << "\n";
+        for(int k = slse.row_start[row_id]; k < slse.row_start[row_id + 1]; k++)
+            coeff_file << row_id << " " << slse.col_index[k] << " " << slse.values[k] << "\n";
+    }
+    coeff_file.close();
+}
+
+/**
+ * @brief Convert a dense system into the CSR format, keeping only the nonzero coefficients.
+ *
+ * @param lse The dense system
+ * @return sparse_linear_system_of_equations The sparse system, without level schedule
+ */
+sparse_linear_system_of_equations sparse_from_dense(linear_system_of_equations lse){
+    int n = lse.unknowns_no;
+    sparse_linear_system_of_equations result;
+    result.unknowns_no = n;
+    result.row_start = new int[n + 1];
+    result.diagonal = new double[n];
+    result.free_terms = new double[n];
+    result.level_start = 0;
+    result.level_rows = 0;
+    result.levels_no = 0;
+
+    result.row_start[0] = 0;
+    for(int row_id = 0; row_id < n; row_id++){
+        int count = 0;
+        for(int col_id = row_id + 1; col_id < n; col_id++)if(lse.coefficients[row_id][col_id] != 0)count += 1;
+        result.row_start[row_id + 1] = result.row_start[row_id] + count;
+    }
+    result.nonzeros_no = result.row_start[n];
+    result.col_index = new int[result.nonzeros_no];
+    result.values = new double[result.nonzeros_no];
+
+    for(int row_id = 0; row_id < n; row_id++){
+        int k = result.row_start[row_id];
+        for(int col_id = row_id + 1; col_id < n; col_id++){
+            if(lse.coefficients[row_id][col_id] != 0){
+                result.col_index[k] = col_id;
+                result.values[k] = lse.coefficients[row_id][col_id];
+                k += 1;
+            }
+        }
+        result.diagonal[row_id] = lse.coefficients[row_id][row_id];
+        result.free_terms[row_id] = lse.free_terms[row_id];
+    }
+    return result;
+}
+
+/**
+ * @brief The symbolic phase: group the rows in levels (wavefronts). A row only depends on the
+ * rows of its nonzero columns, so all the rows of a level can be solved at the same time, once
+ * the previous levels are done. The result is stored in the system and reused by later solves.
+ *
+ * @param slse The sparse system
+ */
+void analyse_sparse_system(sparse_linear_system_of_equations * slse){
+    int n = slse->unknowns_no;
+    int * level = new int[n];
+    int levels_no = 0;
+
+    /* The rows are visited bottom-up, so every dependency already has its level: */
+    for(int row_id = n - 1; row_id > -1; row_id--){
+        int row_level = 0;
+        for(int k = slse->row_start[row_id]; k < slse->row_start[row_id + 1]; k++){
+            if(level[slse->col_index[k]] + 1 > row_level)row_level = level[slse->col_index[k]] + 1;
+        }
+        level[row_id] = row_level;
+        if(row_level + 1 > levels_no)levels_no = row_level + 1;
+    }
+
+    /* Bucket the rows by level: */
+    delete[] slse->level_start;
+    delete[] slse->level_rows;
+    slse->levels_no = levels_no;
+    slse->level_start = new int[levels_no + 1];
+    slse->level_rows = new int[n];
+    for(int level_id = 0; level_id <= levels_no; level_id++)slse->level_start[level_id] = 0;
+    for(int row_id = 0; row_id < n; row_id++)slse->level_start[level[row_id] + 1] += 1;
+    for(int level_id = 0; level_id < levels_no; level_id++)slse->level_start[level_id + 1] += slse->level_start[level_id];
+    int * next = new int[levels_no];
+    for(int level_id = 0; level_id < levels_no; level_id++)next[level_id] = slse->level_start[level_id];
+    for(int row_id = n - 1; row_id > -1; row_id--){
+        slse->level_rows[next[level[row_id]]] = row_id;
+        next[level[row_id]] += 1;
+    }
+
+    delete[] next;
+    delete[] level;
+}
+
+/**
+ * @brief Solve one row of the sparse system, once all its dependencies are known.
+ */
+inline void solve_sparse_row(sparse_linear_system_of_equations * slse, int row_id, double * solution){
+    double sum = slse->free_terms[row_id];
+    for(int k = slse->row_start[row_id]; k < slse->row_start[row_id + 1]; k++)sum -= slse->values[k] * solution[slse->col_index[k]];
+    if(slse->diagonal[row_id] != 0)solution[row_id] = sum / slse->diagonal[row_id];
+    else solution[row_id] = 0;
+}
+
+/**
+ * @brief Solve the sparse system. The first call runs analyse_sparse_system; the following
+ * calls only pay for the numeric phase. The rows of a level are split between the threads.
+ *
+ * @param slse The sparse system
+ * @param number_of_threads The number of OpenMP threads
+ * @return double* The solution of the system
+ */
+double * sparse_system_solver(sparse_linear_system_of_equations * slse, int number_of_threads){
+    int n = slse->unknowns_no;
+    double * solution = new double[n];
+
+    if(slse->level_start == 0)analyse_sparse_system(slse);
+
+    /* Long chains of narrow levels are faster without the barriers: */
+    if(number_of_threads < 2 || n < SPARSE_MIN_LEVEL_WIDTH * slse->levels_no){
+        for(int row_id = n - 1; row_id > -1; row_id--)solve_sparse_row(slse, row_id, solution);
+        return solution;
+    }
+
+    #pragma omp parallel default(none) shared(slse, solution) num_threads(number_of_threads)
+    {
+        for(int level_id = 0; level_id < slse->levels_no; level_id++){
+            #pragma omp for schedule(dynamic, 32)
+            for(int k = slse->level_start[level_id]; k < slse->level_start[level_id + 1]; k++){
+                solve_sparse_row(slse, slse->level_rows[k], solution);
+            }
+        }
+    }
+    return solution;
+}
+
+void free_sparse_system(sparse_linear_system_of_equations slse){
+    delete[] slse.row_start;
+    delete[] slse.col_index;
+    delete[] slse.values;
+    delete[] slse.diagonal;
+    delete[] slse.free_terms;
+    delete[] slse.level_start;
+    delete[] slse.level_rows;
+}
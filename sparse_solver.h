@@ -0,0 +1,39 @@
+#include "linear_system_schema.h"
+
+#ifndef SPARSE_SOLVER_H
+#define SPARSE_SOLVER_H
+
+/**
+ * @brief An upper triangular system stored in CSR format. The diagonal is kept apart;
+ * row_start / col_index / values only hold the strictly upper part of every row.
+ * The level schedule (the rows grouped by wavefront) is built once by analyse_sparse_system
+ * and reused by every following solve; level_start is null until then.
+ */
+struct sparse_linear_system_of_equations {
+    int *row_start;
+    int *col_index;
+    double *values;
+    double *diagonal;
+    double *free_terms;
+    int unknowns_no;
+    int nonzeros_no;
+    int *level_start;
+    int *level_rows;
+    int levels_no;
+};
+
+sparse_linear_system_of_equations build_sparse_system(int * rows, int * cols, double * entry_values, int entries_no, int n);
+
+sparse_linear_system_of_equations read_sparse_linear_system(char * coeff_filename, char * free_terms_filename, char * unknown_no_filename);
+
+void write_sparse_coefficient_matrix(sparse_linear_system_of_equations slse, char * coeff_filename);
+
+sparse_linear_system_of_equations sparse_from_dense(linear_system_of_equations lse);
+
+void analyse_sparse_system(sparse_linear_system_of_equations * slse);
+
+double * sparse_system_solver(sparse_linear_system_of_equations * slse, int number_of_threads);
+
+void free_sparse_system(sparse_linear_system_of_equations slse);
+
+#endif
@@ -0,0 +1,91 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+
+#include <chrono>
+
+#include "linear_system_schema.h"
+#include "generated_pipeline.h"
+#include "solver_library.h"
+
+#define NUMBER_OF_SYSTEMS 1000
+#define STREAM_SEED 1
+
+/**
+ * @brief The reference: back-substitution of one whole system.
+ */
+void solve_whole_system(linear_system_of_equations lse, double * x){
+    for(int sol_id = lse.unknowns_no - 1; sol_id > -1; sol_id--){
+        double sum = lse.free_terms[sol_id];
+        for(int j = sol_id + 1; j < lse.unknowns_no; j++)sum -= lse.coefficients[sol_id][j] * x[j];
+        x[sol_id] = sum / lse.coefficients[sol_id][sol_id];
+    }
+}
+
+void free_system(linear_system_of_equations lse){
+    for(int row_id = 0; row_id < lse.unknowns_no; row_id++)delete[] lse.coefficients[row_id];
+    delete[] lse.coefficients;
+    delete[] lse.free_terms;
+}
+
+/**
+ * @brief Usage: stream_benchmark [n] [systems] [generator_cpu] [solver_cpu]
+ * Compares the pipelined stream with generating then solving every whole system on one thread.
+ */
+int main(int argc, char ** argv){
+    int n = (argc > 1) ? atoi(argv[1]) : 1000;
+    int systems_no = (argc > 2) ? atoi(argv[2]) : NUMBER_OF_SYSTEMS;
+    int generator_cpu = (argc > 3) ? atoi(argv[3]) : 0;
+    int solver_cpu = (argc > 4) ? atoi(argv[4]) : 1;
+    double bytes_per_system = ((double)n * (n + 1) / 2 + n) * sizeof(double);
+
+    /* One core, one whole system at a time, generated into the same preallocated system: */
+    double * x = new double[n];
+    double checksum = 0.0;
+    linear_system_of_equations lse = generate_stream_system(n, STREAM_SEED);
+    std::chrono::high_resolution_clock::time_point begin = std::chrono::high_resolution_clock::now();
+    for(int system_id = 0; system_id < systems_no; system_id++){
+        fill_stream_system(lse, STREAM_SEED + system_id);
+        solve_whole_system(lse, x);
+        for(int sol_id = 0; sol_id < n; sol_id++)checksum += x[sol_id];
+    }
+    std::chrono::high_resolution_clock::time_point end = std::chrono::high_resolution_clock::now();
+    double seconds = std::chrono::duration_cast<std::chrono::nanoseconds>(end - begin).count() * 1e-9;
+    printf("generate then solve: %d systems of %d unknowns in %f s, %.1f systems/s, %.3f GB/s\n",
+           systems_no, n, seconds, systems_no / seconds, systems_no * bytes_per_system / seconds * 1e-9);
+
+    double * first_solution = new double[n];
+    stream_throughput stream = generate_and_solve_stream(n, systems_no, STREAM_SEED, generator_cpu, solver_cpu, first_solution);
+    printf("pipelined stream (cores %d and %d): %d systems of %d unknowns in %f s, %.1f systems/s, %.3f GB/s\n",
+           generator_cpu, solver_cpu, stream.systems_no, n, stream.seconds, stream.systems_per_second, stream.bytes_per_second * 1e-9);
+
+    /* The same rows, in the same order of operations: the results must be identical: */
+    fill_stream_system(lse, STREAM_SEED);
+    solve_whole_system(lse, x);
+    int mismatches = 0;
+    for(int sol_id = 0; sol_id < n; sol_id++){
+        if(x[sol_id] != first_solution[sol_id] && !(isnan(x[sol_id]) && isnan(first_solution[sol_id])))mismatches++;
+    }
+    printf("first system: %d mismatching unknowns, checksums %s\n", mismatches, (checksum == stream.checksum || (isnan(checksum) && isnan(stream.checksum))) ? "equal" : "different");
+
+    /* The same stream, solved by a back-end of the library once the rows of a system are in: */
+    std::unique_ptr<Solver> solver = make_solver(SEQUENTIAL_BACKEND, 1);
+    TriangularSystem assembled(n);
+    solver_stream_state state;
+    state.solver = solver.get();
+    state.system = &assembled;
+    stream = generate_and_solve_stream(n, systems_no, STREAM_SEED, generator_cpu, solver_cpu, first_solution, solver_stream_consumer, &state);
+    printf("pipelined stream into the sequential back-end: %d systems of %d unknowns in %f s, %.1f systems/s, %.3f GB/s\n",
+           stream.systems_no, n, stream.seconds, stream.systems_per_second, stream.bytes_per_second * 1e-9);
+    double max_difference = 0.0;
+    for(int sol_id = 0; sol_id < n; sol_id++){
+        double difference = fabs(x[sol_id] - first_solution[sol_id]) / (fabs(x[sol_id]) + 1e-300);
+        if(difference > max_difference)max_difference = difference;
+    }
+    printf("first system: max relative difference from the back-substitution = %e\n", max_difference);
+
+    free_system(lse);
+    delete[] first_solution;
+    delete[] x;
+    return 0;
+}
@@ -0,0 +1,136 @@
+#include <stdio.h>
+#include <math.h>
+
+#include <chrono>
+#include <fstream>
+#include <vector>
+
+#include "linear_system_schema.h"
+#include "structured_system.h"
+#include "solver_library.h"
+
+#define NUM_THREADS 40
+#define STRUCTURED_UNKNOWNS 4000
+/* The bandwidth of the banded input: */
+#define BENCHMARK_BANDWIDTH 16
+/* About one coefficient in SPARSE_FILL_DIVISOR of the strictly upper part of the sparse input is nonzero: */
+#define SPARSE_FILL_DIVISOR 200
+
+enum benchmark_input { DIAGONAL_INPUT, BANDED_INPUT, SPARSE_INPUT, DENSE_INPUT };
+
+const char * structure_name(matrix_structure structure){
+    switch(structure){
+    case DIAGONAL_STRUCTURE: return "diagonal";
+    case BANDED_STRUCTURE: return "banded";
+    case SPARSE_STRUCTURE: return "sparse";
+    default: return "packed";
+    }
+}
+
+/**
+ * @brief The coefficient (row_id, col_id), col_id >= row_id, of the benchmark input of the given
+ * kind; the diagonal is dominant, so the solutions of the readers can be compared.
+ */
+double benchmark_coefficient(benchmark_input input, int row_id, int col_id, int n){
+    if(col_id == row_id)return n + row_id % 7;
+    bool nonzero;
+    switch(input){
+    case DIAGONAL_INPUT: nonzero = false; break;
+    case BANDED_INPUT: nonzero = col_id - row_id <= BENCHMARK_BANDWIDTH; break;
+    case SPARSE_INPUT: nonzero = ((long long)row_id * 7919 + (long long)col_id * 104729) % SPARSE_FILL_DIVISOR == 0; break;
+    default: nonzero = true;
+    }
+    return nonzero ? ((row_id * 31 + col_id * 17) % 100) * 0.01 + 0.01 : 0.0;
+}
+
+/**
+ * @brief Write the benchmark input of the given kind in the usual text format, one row at a time.
+ */
+void write_benchmark_input(benchmark_input input, int n, const char * coeff_filename, const char * free_terms_filename, const char * unknown_no_filename){
+    std::ofstream unknowns_no_file(unknown_no_filename);
+    unknowns_no_file << n << "\n";
+    unknowns_no_file.close();
+
+    std::ofstream coeff_file(coeff_filename);
+    for(int row_id = 0; row_id < n; row_id++){
+        for(int col_id = row_id; col_id < n; col_id++)coeff_file << benchmark_coefficient(input, row_id, col_id, n) << " ";
+        coeff_file << "\n";
+    }
+    coeff_file.close();
+
+    std::ofstream free_terms_file(free_terms_filename);
+    for(int row_id = 0; row_id < n; row_id++)free_terms_file << (row_id % 13) + 1 << " ";
+    free_terms_file.close();
+}
+
+/**
+ * @brief The number of coefficients the representation of the system stores.
+ */
+long long stored_coefficients(const structured_linear_system & slse){
+    long long n = slse.unknowns_no;
+    switch(slse.structure){
+    case DIAGONAL_STRUCTURE: return n;
+    case BANDED_STRUCTURE: return n * (slse.bandwidth + 1);
+    case SPARSE_STRUCTURE: return slse.sparse.nonzeros_no + n;
+    default: return n * (n + 1) / 2;
+    }
+}
+
+double elapsed_seconds(std::chrono::high_resolution_clock::time_point begin){
+    return std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - begin).count();
+}
+
+/**
+ * @brief Load the input with the structure-aware reader and with the dense one, solve it with
+ * both, and compare the storage, the times and the solutions.
+ */
+void run_benchmark(benchmark_input input, const char * input_name, int n){
+    char coeff_filename[] = "structured_input.txt";
+    char free_terms_filename[] = "structured_free_terms.txt";
+    char unknown_no_filename[] = "structured_unknown_no.txt";
+    write_benchmark_input(input, n, coeff_filename, free_terms_filename, unknown_no_filename);
+
+    auto begin = std::chrono::high_resolution_clock::now();
+    structured_linear_system slse = read_structured_linear_system(coeff_filename, free_terms_filename, unknown_no_filename);
+    double structured_load = elapsed_seconds(begin);
+    if(slse.unknowns_no != n){
+        free_structured_system(slse);
+        return;
+    }
+    begin = std::chrono::high_resolution_clock::now();
+    double * structured_solution = structured_system_solver(&slse, NUM_THREADS);
+    double structured_solve = elapsed_seconds(begin);
+
+    begin = std::chrono::high_resolution_clock::now();
+    TriangularSystem system = TriangularSystem::read(coeff_filename, free_terms_filename, unknown_no_filename, RAW_COEFFICIENTS);
+    double dense_load = elapsed_seconds(begin);
+    begin = std::chrono::high_resolution_clock::now();
+    std::vector<double> dense_solution = make_solver(SEQUENTIAL_BACKEND, 1)->solve(system);
+    double dense_solve = elapsed_seconds(begin);
+
+    double difference = 0.0, magnitude = 0.0;
+    for(int i = 0; i < n; i++){
+        difference = fmax(difference, fabs(structured_solution[i] - dense_solution[i]));
+        magnitude = fmax(magnitude, fabs(dense_solution[i]));
+    }
+
+    printf("%s input (n = %d): %s storage, bandwidth %d, %lld nonzeros, %lld coefficients stored (dense: %lld)\n",
+           input_name, n, structure_name(slse.structure), slse.bandwidth, slse.nonzeros_no, stored_coefficients(slse), (long long)n * n);
+    printf("    structured: load %f s, solve %f s\n", structured_load, structured_solve);
+    printf("    dense:      load %f s, solve %f s\n", dense_load, dense_solve);
+    printf("    max relative difference = %e\n", difference / magnitude);
+
+    delete[] structured_solution;
+    free_structured_system(slse);
+    remove(coeff_filename);
+    remove(free_terms_filename);
+    remove(unknown_no_filename);
+}
+
+int main(){
+    run_benchmark(DIAGONAL_INPUT, "diagonal", STRUCTURED_UNKNOWNS);
+    run_benchmark(BANDED_INPUT, "banded", STRUCTURED_UNKNOWNS);
+    run_benchmark(SPARSE_INPUT, "sparse", STRUCTURED_UNKNOWNS);
+    run_benchmark(DENSE_INPUT, "dense", STRUCTURED_UNKNOWNS);
+    return 0;
+}
@@ -0,0 +1,253 @@
+#include "structured_system.h"
+#include "solver_library.h"
+#include <fstream>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/**
+ * @brief Release the buffers of a reader that could not finish, and report the error.
+ */
+structured_linear_system abandon_structured_read(structured_linear_system result, double * rows, long long * row_offset, int * row_extent, double * line, const char * error){
+    printf("%s\n", error);
+    free(rows);
+    delete[] row_offset;
+    delete[] row_extent;
+    delete[] line;
+    result.unknowns_no = 0;
+    return result;
+}
+
+/**
+ * @brief Read a system in the usual text format (row i holds the n - i coefficients of the upper
+ * triangle) and store it in the representation that matches its structure. While parsing, every
+ * row is trimmed after its last nonzero coefficient and appended to one buffer, so a banded
+ * matrix never needs O(n^2) memory; the chosen representation is then built in place in that
+ * buffer, so the rows and the final copy are never both in memory.
+ * The structure is that of the values after the convention: READER_CONVENTION reads every zero
+ * coefficient as 1, so it always gives a packed matrix; the default is to keep the zeros.
+ *
+ * @param coeff_filename The name of the file that stores the coefficient matrix
+ * @param free_terms_filename The name of the file that stores the free terms
+ * @param unknown_no_filename The name of the file that stores the number of unknowns
+ * @param convention How the values of the files are read (see coefficient_convention)
+ * @return structured_linear_system The system, in its detected representation; it has no unknowns
+ *         if the files could not be read or the buffers could not be allocated
+ */
+structured_linear_system read_structured_linear_system(char * coeff_filename, char * free_terms_filename, char * unknown_no_filename, coefficient_convention convention){
+    structured_linear_system result;
+    result.structure = PACKED_STRUCTURE;
+    result.unknowns_no = 0;
+    result.bandwidth = 0;
+    result.nonzeros_no = 0;
+    result.diagonal = 0;
+    result.band = 0;
+    result.packed = 0;
+    result.sparse.row_start = 0;
+    result.sparse.col_index = 0;
+    result.sparse.values = 0;
+    result.sparse.diagonal = 0;
+    result.sparse.free_terms = 0;
+    result.sparse.level_start = 0;
+    result.sparse.level_rows = 0;
+    result.free_terms = 0;
+
+    int n = 0;
+    std::ifstream unknowns_no_file(unknown_no_filename);
+    if(!(unknowns_no_file >> n) || n < 1){
+        printf("Could not read the number of unknowns from %s\n", unknown_no_filename);
+        return result;
+    }
+    unknowns_no_file.close();
+    std::ifstream coeff_file(coeff_filename);
+    if(!coeff_file.is_open()){
+        printf("Could not open %s\n", coeff_filename);
+        return result;
+    }
+    result.unknowns_no = n;
+
+    /* First pass: parse the rows, trimmed after their last nonzero, into one growing buffer
+     * (row_offset[row] is where the row starts), and measure the structure: */
+    long long capacity = n;
+    long long used = 0;
+    double * rows = (double *)malloc(capacity * sizeof(double));
+    long long * row_offset = new long long[n];
+    int * row_extent = new int[n];
+    double * line = new double[n];
+    long long band_area = 0;
+    if(rows == NULL)return abandon_structured_read(result, rows, row_offset, row_extent, line, "Could not allocate the coefficients");
+
+    for(int row_id = 0; row_id < n; row_id++){
+        int extent = 0;
+        for(int col_id = row_id; col_id < n; col_id++){
+            double value = read_coefficient(coeff_file, convention);
+            line[col_id - row_id] = value;
+            if(value != 0){
+                result.nonzeros_no += 1;
+                extent = col_id - row_id;
+            }
+        }
+        if(used + extent + 1 > capacity){
+            /* realloc of a large block remaps its pages instead of copying them: */
+            while(used + extent + 1 > capacity)capacity *= 2;
+            long long packed_size = (long long)n * (n + 1) / 2;
+            if(capacity > packed_size)capacity = packed_size;
+            double * grown = (double *)realloc(rows, capacity * sizeof(double));
+            if(grown == NULL)return abandon_structured_read(result, rows, row_offset, row_extent, line, "Could not allocate the coefficients");
+            rows = grown;
+        }
+        for(int i = 0; i <= extent; i++)rows[used + i] = line[i];
+        row_offset[row_id] = used;
+        row_extent[row_id] = extent;
+        used += extent + 1;
+        band_area += extent + 1;
+        if(extent > result.bandwidth)result.bandwidth = extent;
+    }
+    coeff_file.close();
+    delete[] line;
+    line = 0;
+
+    /* Choose the representation: */
+    if(result.bandwidth == 0)result.structure = DIAGONAL_STRUCTURE;
+    else if(result.nonzeros_no * SPARSE_DENSITY_DIVISOR < band_area)result.structure = SPARSE_STRUCTURE;
+    else if((long long)result.bandwidth * BANDED_WIDTH_DIVISOR < n)result.structure = BANDED_STRUCTURE;
+    else result.structure = PACKED_STRUCTURE;
+
+    /* Second pass: build the chosen representation in the buffer. A row never starts later in the
+     * buffer than in the diagonal, banded or packed layout, so the diagonal is compacted from the
+     * first row and the other layouts are spread from the last row, without overwriting a row
+     * that has not been moved yet: */
+    if(result.structure == DIAGONAL_STRUCTURE){
+        for(int row_id = 0; row_id < n; row_id++)rows[row_id] = rows[row_offset[row_id]];
+        /* Shrinking cannot fail to keep the data; on failure the larger block is kept: */
+        double * shrunk = (double *)realloc(rows, n * sizeof(double));
+        result.diagonal = (shrunk != NULL) ? shrunk : rows;
+    }
+    else if(result.structure == BANDED_STRUCTURE || result.structure == PACKED_STRUCTURE){
+        int width = result.bandwidth + 1;
+        long long size = (result.structure == BANDED_STRUCTURE) ? (long long)n * width : (long long)n * (n + 1) / 2;
+        if(size > capacity){
+            double * grown = (double *)realloc(rows, size * sizeof(double));
+            if(grown == NULL)return abandon_structured_read(result, rows, row_offset, row_extent, line, "Could not allocate the coefficients");
+            rows = grown;
+        }
+        for(int row_id = n - 1; row_id > -1; row_id--){
+            long long offset;
+            int length;
+            if(result.structure == BANDED_STRUCTURE){
+                offset = (long long)row_id * width;
+                length = width;
+            }
+            else{
+                offset = (long long)row_id * n - (long long)row_id * (row_id - 1) / 2;
+                length = n - row_id;
+            }
+            memmove(rows + offset, rows + row_offset[row_id], (row_extent[row_id] + 1) * sizeof(double));
+            for(int i = row_extent[row_id] + 1; i < length; i++)rows[offset + i] = 0.0;
+        }
+        if(result.structure == BANDED_STRUCTURE)result.band = rows;
+        else result.packed = rows;
+    }
+    else{
+        int entries_no = (int)result.nonzeros_no + n;
+        int * entry_rows = new int[entries_no];
+        int * entry_cols = new int[entries_no];
+        double * entry_values = new double[entries_no];
+        int entry_id = 0;
+        for(int row_id = 0; row_id < n; row_id++){
+            double * row = rows + row_offset[row_id];
+            for(int i = 0; i <= row_extent[row_id]; i++){
+                if(i == 0 || row[i] != 0){
+                    entry_rows[entry_id] = row_id;
+                    entry_cols[entry_id] = row_id + i;
+                    entry_values[entry_id] = row[i];
+                    entry_id += 1;
+                }
+            }
+        }
+        free(rows);
+        result.sparse = build_sparse_system(entry_rows, entry_cols, entry_values, entry_id, n);
+        delete[] entry_rows;
+        delete[] entry_cols;
+        delete[] entry_values;
+    }
+
+    delete[] row_offset;
+    delete[] row_extent;
+
+    result.free_terms = new double[n];
+    std::ifstream free_terms_file(free_terms_filename);
+    for(int eq_id = 0; eq_id < n; eq_id++)result.free_terms[eq_id] = read_free_term(free_terms_file, convention);
+    free_terms_file.close();
+    if(result.structure == SPARSE_STRUCTURE){
+        result.sparse.free_terms = new double[n];
+        for(int eq_id = 0; eq_id < n; eq_id++)result.sparse.free_terms[eq_id] = result.free_terms[eq_id];
+    }
+
+    return result;
+}
+
+/**
+ * @brief O(n * k) back-substitution for a matrix of bandwidth k.
+ */
+void banded_back_substitution(structured_linear_system * slse, double * solution){
+    int n = slse->unknowns_no;
+    int width = slse->bandwidth + 1;
+    for(int row_id = n - 1; row_id > -1; row_id--){
+        double * band_row = slse->band + (long long)row_id * width;
+        int last = (width < n - row_id) ? width : n - row_id;
+        double sum = slse->free_terms[row_id];
+        #pragma omp simd reduction(-:sum)
+        for(int i = 1; i < last; i++)sum -= band_row[i] * solution[row_id + i];
+        if(band_row[0] != 0)solution[row_id] = sum / band_row[0];
+        else solution[row_id] = 0;
+    }
+}
+
+/**
+ * @brief Back-substitution over the packed upper triangle; every row is read contiguously.
+ */
+void packed_back_substitution(structured_linear_system * slse, double * solution){
+    int n = slse->unknowns_no;
+    for(int row_id = n - 1; row_id > -1; row_id--){
+        double * packed_row = slse->packed + (long long)row_id * n - (long long)row_id * (row_id - 1) / 2;
+        double sum = slse->free_terms[row_id];
+        #pragma omp simd reduction(-:sum)
+        for(int i = 1; i < n - row_id; i++)sum -= packed_row[i] * solution[row_id + i];
+        if(packed_row[0] != 0)solution[row_id] = sum / packed_row[0];
+        else solution[row_id] = 0;
+    }
+}
+
+/**
+ * @brief Solve the system with the solver specialized for its representation.
+ *
+ * @param slse The system, as returned by read_structured_linear_system
+ * @param number_of_threads The number of OpenMP threads (used by the diagonal and sparse solvers)
+ * @return double* The solution of the system
+ */
+double * structured_system_solver(structured_linear_system * slse, int number_of_threads){
+    int n = slse->unknowns_no;
+    if(slse->structure == SPARSE_STRUCTURE)return sparse_system_solver(&slse->sparse, number_of_threads);
+
+    double * solution = new double[n];
+    if(slse->structure == DIAGONAL_STRUCTURE){
+        #pragma omp parallel for schedule(static) num_threads(number_of_threads)
+        for(int row_id = 0; row_id < n; row_id++){
+            if(slse->diagonal[row_id] != 0)solution[row_id] = slse->free_terms[row_id] / slse->diagonal[row_id];
+            else solution[row_id] = 0;
+        }
+    }
+    else if(slse->structure == BANDED_STRUCTURE)banded_back_substitution(slse, solution);
+    else packed_back_substitution(slse, solution);
+    return solution;
+}
+
+void free_structured_system(structured_linear_system slse){
+    /* The diagonal, the band and the packed triangle are the buffer of the reader, from malloc: */
+    free(slse.diagonal);
+    free(slse.band);
+    free(slse.packed);
+    delete[] slse.free_terms;
+    if(slse.structure == SPARSE_STRUCTURE)free_sparse_system(slse.sparse);
+}
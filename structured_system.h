@@ -0,0 +1,45 @@
+#include "linear_system_schema.h"
+#include "sparse_solver.h"
+
+#ifndef STRUCTURED_SYSTEM_H
+#define STRUCTURED_SYSTEM_H
+
+/* Use the sparse storage when fewer than 1 / SPARSE_DENSITY_DIVISOR of the band is nonzero: */
+#define SPARSE_DENSITY_DIVISOR 10
+/* Use the banded storage when the band is narrower than 1 / BANDED_WIDTH_DIVISOR of the matrix: */
+#define BANDED_WIDTH_DIVISOR 4
+
+enum matrix_structure {
+    DIAGONAL_STRUCTURE,
+    BANDED_STRUCTURE,
+    PACKED_STRUCTURE,
+    SPARSE_STRUCTURE
+};
+
+/**
+ * @brief An upper triangular system stored in the representation that matches its structure.
+ * Only the member of the chosen structure is allocated:
+ * - DIAGONAL_STRUCTURE: diagonal[row]
+ * - BANDED_STRUCTURE: band[row * (bandwidth + 1) + (col - row)], for row <= col <= row + bandwidth
+ * - PACKED_STRUCTURE: packed[row * n - row * (row - 1) / 2 + (col - row)], for col >= row
+ * - SPARSE_STRUCTURE: sparse, see sparse_solver.h
+ */
+struct structured_linear_system {
+    matrix_structure structure;
+    int unknowns_no;
+    int bandwidth;
+    long long nonzeros_no;
+    double *diagonal;
+    double *band;
+    double *packed;
+    sparse_linear_system_of_equations sparse;
+    double *free_terms;
+};
+
+structured_linear_system read_structured_linear_system(char * coeff_filename, char * free_terms_filename, char * unknown_no_filename, coefficient_convention convention = RAW_COEFFICIENTS);
+
+double * structured_system_solver(structured_linear_system * slse, int number_of_threads);
+
+void free_structured_system(structured_linear_system slse);
+
+#endif
@@ -0,0 +1,333 @@
+#include <mpi.h>
+#include <omp.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <limits.h>
+#include <sched.h>
+#include <unistd.h>
+#include <sys/syscall.h>
+#include <linux/futex.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <vector>
+
+/* The number of timed episodes of every primitive, after SYNC_WARMUP_EPISODES untimed ones: */
+#define SYNC_EPISODES 10000
+#define SYNC_WARMUP_EPISODES 100
+/* The MPI primitives are slower; fewer episodes are enough: */
+#define SYNC_MPI_EPISODES 2000
+/* A spinning thread gives its core away after this many polls, so oversubscribed runs still finish: */
+#define SPIN_BEFORE_YIELD 1000
+#define NUM_THREADS 40
+
+std::chrono::high_resolution_clock::time_point now(){
+    return std::chrono::high_resolution_clock::now();
+}
+
+double seconds_between(std::chrono::high_resolution_clock::time_point begin, std::chrono::high_resolution_clock::time_point end){
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(end - begin).count() * 1e-9;
+}
+
+/**
+ * @brief Print the mean and the tail of the latencies of one primitive, in microseconds.
+ *
+ * @param primitive_name The name of the primitive
+ * @param participants_no The number of threads or ranks that took part
+ * @param latencies The latency of every episode, in seconds
+ */
+void print_latencies(const char * primitive_name, int participants_no, std::vector<double> latencies){
+    if(latencies.empty())return;
+    std::sort(latencies.begin(), latencies.end());
+    double total = 0.0;
+    for(size_t i = 0; i < latencies.size(); i++)total += latencies[i];
+    const double quantiles[] = {0.5, 0.9, 0.99, 0.999};
+    printf("%-18s %5d %10.3f", primitive_name, participants_no, 1e6 * total / latencies.size());
+    for(int q = 0; q < 4; q++)printf(" %10.3f", 1e6 * latencies[(size_t)(quantiles[q] * (latencies.size() - 1))]);
+    printf(" %10.3f\n", 1e6 * latencies.back());
+}
+
+void print_latency_header(){
+    printf("%-18s %5s %10s %10s %10s %10s %10s %10s   (microseconds)\n", "primitive", "p", "mean", "p50", "p90", "p99", "p99.9", "max");
+}
+
+/**
+ * @brief Poll until the value reaches target, yielding the core once in a while.
+ */
+void spin_until_at_least(const std::atomic<int> & value, int target){
+    int polls = 0;
+    while(value.load(std::memory_order_acquire) < target){
+        if(++polls == SPIN_BEFORE_YIELD){
+            polls = 0;
+            sched_yield();
+        }
+    }
+}
+
+/**
+ * @brief A centralized sense-reversing barrier: the last thread to arrive resets the counter and
+ * flips the global sense, the others spin on it. Every thread keeps its own local sense.
+ */
+struct spin_barrier {
+    alignas(64) std::atomic<int> remaining;
+    alignas(64) std::atomic<int> sense;
+    int threads_no;
+};
+
+void spin_barrier_wait(spin_barrier * barrier, int & local_sense){
+    local_sense = 1 - local_sense;
+    if(barrier->remaining.fetch_sub(1, std::memory_order_acq_rel) == 1){
+        barrier->remaining.store(barrier->threads_no, std::memory_order_relaxed);
+        barrier->sense.store(local_sense, std::memory_order_release);
+        return;
+    }
+    int polls = 0;
+    while(barrier->sense.load(std::memory_order_acquire) != local_sense){
+        if(++polls == SPIN_BEFORE_YIELD){
+            polls = 0;
+            sched_yield();
+        }
+    }
+}
+
+enum barrier_kind { OPEN_MP_BARRIER, SPIN_BARRIER };
+
+/**
+ * @brief Back-to-back barriers of a team: thread 0 records the time of every barrier episode.
+ */
+std::vector<double> time_barrier(barrier_kind kind, int number_of_threads, int episodes_no){
+    std::vector<double> latencies(episodes_no);
+    spin_barrier barrier;
+    barrier.remaining.store(number_of_threads);
+    barrier.sense.store(0);
+    barrier.threads_no = number_of_threads;
+
+    #pragma omp parallel num_threads(number_of_threads)
+    {
+        int local_sense = 0;
+        bool is_master = omp_get_thread_num() == 0;
+        std::chrono::high_resolution_clock::time_point previous = now();
+        for(int episode = -SYNC_WARMUP_EPISODES; episode < episodes_no; episode++){
+            if(kind == OPEN_MP_BARRIER){
+                #pragma omp barrier
+            }
+            else spin_barrier_wait(&barrier, local_sense);
+            if(is_master){
+                std::chrono::high_resolution_clock::time_point current = now();
+                if(episode >= 0)latencies[episode] = seconds_between(previous, current);
+                previous = current;
+            }
+        }
+    }
+    return latencies;
+}
+
+enum wakeup_kind { FUTEX_WAKEUP, EPOCH_FLAG_WAKEUP };
+
+/**
+ * @brief One thread publishes a new epoch (as the owner of a solved unknown does) and the others
+ * wake up and acknowledge it. The latency is the time from the publication to the last
+ * acknowledgement. With FUTEX_WAKEUP the waiters sleep in the kernel; with EPOCH_FLAG_WAKEUP
+ * they spin on the epoch.
+ */
+std::vector<double> time_wakeup(wakeup_kind kind, int number_of_threads, int episodes_no){
+    std::vector<double> latencies(episodes_no);
+    alignas(64) std::atomic<int> epoch(0);
+    alignas(64) std::atomic<int> acknowledged(0);
+    int waiters_no = number_of_threads - 1;
+
+    #pragma omp parallel num_threads(number_of_threads)
+    {
+        if(omp_get_thread_num() == 0){
+            for(int episode = 1; episode <= SYNC_WARMUP_EPISODES + episodes_no; episode++){
+                std::chrono::high_resolution_clock::time_point begin = now();
+                epoch.store(episode, std::memory_order_release);
+                if(kind == FUTEX_WAKEUP)syscall(SYS_futex, (int *)&epoch, FUTEX_WAKE_PRIVATE, INT_MAX, NULL, NULL, 0);
+                spin_until_at_least(acknowledged, episode * waiters_no);
+                if(episode > SYNC_WARMUP_EPISODES)latencies[episode - SYNC_WARMUP_EPISODES - 1] = seconds_between(begin, now());
+            }
+        }
+        else{
+            for(int episode = 1; episode <= SYNC_WARMUP_EPISODES + episodes_no; episode++){
+                if(kind == FUTEX_WAKEUP){
+                    int seen;
+                    while((seen = epoch.load(std::memory_order_acquire)) < episode)
+                        syscall(SYS_futex, (int *)&epoch, FUTEX_WAIT_PRIVATE, seen, NULL, NULL, 0);
+                }
+                else spin_until_at_least(epoch, episode);
+                acknowledged.fetch_add(1, std::memory_order_acq_rel);
+            }
+        }
+    }
+    return latencies;
+}
+
+void do_nothing(){}
+
+/**
+ * @brief The cost of a parallel step of threads_assignment: spawn number_of_threads threads, join them.
+ */
+std::vector<double> time_spawn_join(int number_of_threads, int episodes_no){
+    std::vector<double> latencies(episodes_no);
+    for(int episode = -SYNC_WARMUP_EPISODES; episode < episodes_no; episode++){
+        std::chrono::high_resolution_clock::time_point begin = now();
+        std::vector<std::thread> threads;
+        for(int thread_id = 0; thread_id < number_of_threads; thread_id++)threads.push_back(std::thread(do_nothing));
+        for(int thread_id = 0; thread_id < number_of_threads; thread_id++)threads[thread_id].join();
+        if(episode >= 0)latencies[episode] = seconds_between(begin, now());
+    }
+    return latencies;
+}
+
+enum broadcast_kind { BLOCKING_BROADCAST, NONBLOCKING_BROADCAST };
+
+/**
+ * @brief One double broadcast from a rotating root (the owner of the unknown, as in solution1).
+ * Every episode starts after a barrier; its latency is the slowest rank's MPI_Bcast (or
+ * MPI_Ibcast + MPI_Wait), so only the ranks' own clocks are compared.
+ *
+ * @return std::vector<double> The latencies on rank 0, empty on the other ranks
+ */
+std::vector<double> time_broadcast(broadcast_kind kind, int episodes_no){
+    int world_rank;
+    MPI_Comm_rank(MPI_COMM_WORLD, &world_rank);
+    int world_size;
+    MPI_Comm_size(MPI_COMM_WORLD, &world_size);
+
+    std::vector<double> local(episodes_no);
+    double value = 0.0;
+    for(int episode = -SYNC_WARMUP_EPISODES; episode < episodes_no; episode++){
+        int root = (episode + SYNC_WARMUP_EPISODES) % world_size;
+        if(world_rank == root)value = episode;
+        MPI_Barrier(MPI_COMM_WORLD);
+        double begin = MPI_Wtime();
+        if(kind == BLOCKING_BROADCAST)MPI_Bcast(&value, 1, MPI_DOUBLE, root, MPI_COMM_WORLD);
+        else{
+            MPI_Request request;
+            MPI_Ibcast(&value, 1, MPI_DOUBLE, root, MPI_COMM_WORLD, &request);
+            MPI_Wait(&request, MPI_STATUS_IGNORE);
+        }
+        if(episode >= 0)local[episode] = MPI_Wtime() - begin;
+    }
+
+    std::vector<double> latencies(world_rank == 0 ? episodes_no : 0);
+    MPI_Reduce(local.data(), latencies.data(), episodes_no, MPI_DOUBLE, MPI_MAX, 0, MPI_COMM_WORLD);
+    return latencies;
+}
+
+/**
+ * @brief Rank 0 MPI_Puts the episode number into the flag of every other rank (passive target,
+ * as in solution3); every rank polls its flag and acknowledges with an MPI_Accumulate into a
+ * counter of rank 0. The latency is the round trip seen by rank 0.
+ *
+ * @return std::vector<double> The latencies on rank 0, empty on the other ranks
+ */
+std::vector<double> time_put(int episodes_no){
+    int world_rank;
+    MPI_Comm_rank(MPI_COMM_WORLD, &world_rank);
+    int world_size;
+    MPI_Comm_size(MPI_COMM_WORLD, &world_size);
+
+    /* cells[0] is the flag written by rank 0, cells[1] the acknowledgement counter of rank 0: */
+    int * cells;
+    MPI_Win window;
+    MPI_Win_allocate(2 * sizeof(int), sizeof(int), MPI_INFO_NULL, MPI_COMM_WORLD, &cells, &window);
+    cells[0] = 0;
+    cells[1] = 0;
+    MPI_Win_lock_all(0, window);
+    MPI_Barrier(MPI_COMM_WORLD);
+
+    std::vector<double> latencies(world_rank == 0 ? episodes_no : 0);
+    int one = 1;
+    int message_waiting = 0;
+    for(int episode = 1; episode <= SYNC_WARMUP_EPISODES + episodes_no; episode++){
+        if(world_rank == 0){
+            double begin = MPI_Wtime();
+            for(int other_rank = 1; other_rank < world_size; other_rank++)
+                MPI_Put(&episode, 1, MPI_INT, other_rank, 0, 1, MPI_INT, window);
+            MPI_Win_flush_all(window);
+            while(true){
+                MPI_Win_sync(window);
+                if(((volatile int *)cells)[1] >= episode * (world_size - 1))break;
+                MPI_Iprobe(MPI_ANY_SOURCE, MPI_ANY_TAG, MPI_COMM_WORLD, &message_waiting, MPI_STATUS_IGNORE);
+            }
+            if(episode > SYNC_WARMUP_EPISODES)latencies[episode - SYNC_WARMUP_EPISODES - 1] = MPI_Wtime() - begin;
+        }
+        else{
+            while(true){
+                MPI_Win_sync(window);
+                if(((volatile int *)cells)[0] >= episode)break;
+                MPI_Iprobe(MPI_ANY_SOURCE, MPI_ANY_TAG, MPI_COMM_WORLD, &message_waiting, MPI_STATUS_IGNORE);
+            }
+            MPI_Accumulate(&one, 1, MPI_INT, 0, 1, 1, MPI_INT, MPI_SUM, window);
+            MPI_Win_flush(0, window);
+        }
+    }
+
+    MPI_Win_unlock_all(window);
+    MPI_Win_free(&window);
+    return latencies;
+}
+
+/**
+ * @brief Usage: mpirun -np P sync_benchmark [max_threads] [episodes]
+ * The thread primitives run on rank 0 for 1, 2, 4, ... max_threads threads; the MPI primitives
+ * run on all the ranks. A solver step has to do several times the p50 of the primitive it
+ * synchronizes with to not be dominated by it, and the p99 / max columns show what the slowest
+ * of many steps costs.
+ */
+int main(int argc, char ** argv){
+    MPI_Init(&argc, &argv);
+    int world_rank;
+    MPI_Comm_rank(MPI_COMM_WORLD, &world_rank);
+    int world_size;
+    MPI_Comm_size(MPI_COMM_WORLD, &world_size);
+
+    int max_threads = (argc > 1) ? atoi(argv[1]) : NUM_THREADS;
+    int episodes_no = (argc > 2) ? atoi(argv[2]) : SYNC_EPISODES;
+    /* Every rank reads the same arguments, so they all stop together: */
+    if(max_threads < 1 || episodes_no < 1){
+        if(world_rank == 0){
+            if(max_threads < 1)printf("invalid number of threads %s\n", argv[1]);
+            else printf("invalid number of episodes %s\n", argv[2]);
+        }
+        MPI_Finalize();
+        return 1;
+    }
+    int mpi_episodes_no = std::min(episodes_no, SYNC_MPI_EPISODES);
+
+    if(world_rank == 0){
+        printf("threads (hardware threads: %u)\n", std::thread::hardware_concurrency());
+        print_latency_header();
+        for(int threads_no = 1; threads_no <= max_threads; threads_no = (threads_no == max_threads) ? threads_no + 1 : std::min(2 * threads_no, max_threads)){
+            print_latencies("spawn_join", threads_no, time_spawn_join(threads_no, episodes_no));
+            print_latencies("omp_barrier", threads_no, time_barrier(OPEN_MP_BARRIER, threads_no, episodes_no));
+            print_latencies("spin_barrier", threads_no, time_barrier(SPIN_BARRIER, threads_no, episodes_no));
+            if(threads_no < 2)continue;
+            print_latencies("futex_wakeup", threads_no, time_wakeup(FUTEX_WAKEUP, threads_no, episodes_no));
+            print_latencies("epoch_flag_wakeup", threads_no, time_wakeup(EPOCH_FLAG_WAKEUP, threads_no, episodes_no));
+        }
+    }
+    MPI_Barrier(MPI_COMM_WORLD);
+
+    if(world_size < 2){
+        if(world_rank == 0)printf("\nMPI: run with mpirun -np 2 or more to measure the MPI primitives\n");
+    }
+    else{
+        std::vector<double> bcast_latencies = time_broadcast(BLOCKING_BROADCAST, mpi_episodes_no);
+        std::vector<double> ibcast_latencies = time_broadcast(NONBLOCKING_BROADCAST, mpi_episodes_no);
+        std::vector<double> put_latencies = time_put(mpi_episodes_no);
+        if(world_rank == 0){
+            printf("\nMPI ranks\n");
+            print_latency_header();
+            print_latencies("bcast", world_size, bcast_latencies);
+            print_latencies("ibcast_wait", world_size, ibcast_latencies);
+            print_latencies("put_round_trip", world_size, put_latencies);
+        }
+    }
+
+    MPI_Finalize();
+    return 0;
+}
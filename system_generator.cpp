@@ -1,13 +1,11 @@
+#include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include <time.h>
 #include <math.h>
 #include <fstream>
 
-struct linear_system_of_equations {
-    double **coefficients;
-    double *free_terms;
-    int unknowns_no;
-};
+#include "system_generator.h"
 
 /**
  * @brief Generate a random system of equations of n equations in n unknowns.
@@ -16,8 +14,20 @@ struct linear_system_of_equations {
  * @return linear_system_of_equations The random linear system of equations generated
  */
 linear_system_of_equations generate_system(int n){
+    return generate_seeded_system(n, (unsigned int)time(NULL));
+}
 
-    srand(time(NULL));
+/**
+ * @brief Generate the random system of generate_system from a given seed, so that the same
+ * system can be generated again (for instance by every run of a scaling study).
+ * 
+ * @param n The number of unknowns and equations in the system
+ * @param seed The seed of the random number generator
+ * @return linear_system_of_equations The random linear system of equations generated
+ */
+linear_system_of_equations generate_seeded_system(int n, unsigned int seed){
+
+    srand(seed);
 
     linear_system_of_equations result;
 
@@ -40,6 +50,32 @@ linear_system_of_equations generate_system(int n){
     return result;
 }
 
+/**
+ * @brief Generate a random general (dense, not triangular) system of n equations in n unknowns.
+ * 
+ * @param n The number of unknowns and equations in the system
+ * @return linear_system_of_equations The random linear system of equations generated
+ */
+linear_system_of_equations generate_general_system(int n){
+
+    srand(time(NULL));
+
+    linear_system_of_equations result;
+
+    result.coefficients = new double*[n];
+    for(int row = 0; row < n; row++){
+        result.coefficients[row] = new double[n];
+        for(int col = 0; col < n; col++)result.coefficients[row][col] = rand() * 0.1;
+    }
+
+    result.free_terms = new double[n];
+    for(int row = 0; row < n; row++)result.free_terms[row] = rand() * 0.1;
+
+    result.unknowns_no = n;
+
+    return result;
+}
+
 /**
  * @brief Write the coefficient matrix
  * 
@@ -59,6 +95,65 @@ void write_coefficient_matrix(double ** coeff, char * coeff_filename, int number
     coeff_file.close();
 }
 
+/**
+ * @brief Write the coefficient matrix, with the rows in the chosen order. With BOTTOM_UP_ROWS,
+ * the last equation comes first, which is the order in which the back-substitution needs them.
+ * 
+ * @param coeff a 2-dimensional array, representing the coefficient matrix of a linear system
+ * @param coeff_filename the name of the file to be generated
+ * @param number_of_unknowns the number of unknowns in the equations
+ * @param order the order of the rows in the file
+ */
+void write_coefficient_matrix_in_order(double ** coeff, char * coeff_filename, int number_of_unknowns, row_order order){
+
+    std::ofstream coeff_file;
+    coeff_file.open(coeff_filename);
+    for(int i = 0; i < number_of_unknowns; i++){
+        int row_id = (order == BOTTOM_UP_ROWS) ? number_of_unknowns - 1 - i : i;
+        for(int col_id = row_id; col_id < number_of_unknowns; col_id++) coeff_file << coeff[row_id][col_id] << " ";
+        coeff_file << "\n";
+    }
+    coeff_file.close();
+}
+
+/**
+ * @brief Write the upper triangle of the coefficient matrix as raw doubles: row i is stored as
+ * its n - i coefficients, with the rows in the chosen order.
+ * 
+ * @param coeff a 2-dimensional array, representing the coefficient matrix of a linear system
+ * @param coeff_filename the name of the file to be generated
+ * @param number_of_unknowns the number of unknowns in the equations
+ * @param order the order of the rows in the file
+ */
+void write_binary_coefficient_matrix(double ** coeff, char * coeff_filename, int number_of_unknowns, row_order order){
+
+    std::ofstream coeff_file;
+    coeff_file.open(coeff_filename, std::ios_base::binary);
+    for(int i = 0; i < number_of_unknowns; i++){
+        int row_id = (order == BOTTOM_UP_ROWS) ? number_of_unknowns - 1 - i : i;
+        coeff_file.write((char *)(coeff[row_id] + row_id), sizeof(double) * (number_of_unknowns - row_id));
+    }
+    coeff_file.close();
+}
+
+/**
+ * @brief Write all the coefficients of a general system, one equation per line
+ * 
+ * @param coeff a 2-dimensional array, representing the coefficient matrix of a linear system
+ * @param coeff_filename the name of the file to be generated
+ * @param number_of_unknowns the number of unknowns in the equations
+ */
+void write_general_coefficient_matrix(double ** coeff, char * coeff_filename, int number_of_unknowns){
+
+    std::ofstream coeff_file;
+    coeff_file.open(coeff_filename);
+    for(int row_id = 0; row_id < number_of_unknowns; row_id++){
+        for(int col_id = 0; col_id < number_of_unknowns; col_id++) coeff_file << coeff[row_id][col_id] << " ";
+        coeff_file << "\n";
+    }
+    coeff_file.close();
+}
+
 /**
  * @brief 
  * 
@@ -101,13 +196,42 @@ void write_system_of_equations(linear_system_of_equations lse, char * coeff_file
     write_free_terms_array(lse.free_terms, free_terms_filename, lse.unknowns_no);
 }
 
-int main(){
+/**
+ * @brief Usage: system_generator [n seed coeff_file free_terms_file unknown_no_file [layout]]
+ * Without arguments, a new n = 10000 system is written to the usual files. The layout of the
+ * coefficient file is one of:
+ * - top_down (the default): text, row 0 first, for read_linear_system
+ * - bottom_up: text, row n - 1 first, for pipelined_load_and_solve
+ * - binary: raw doubles, row n - 1 first, for pipelined_load_and_solve
+ */
+int main(int argc, char ** argv){
     int number_of_equations = 10000;
     char * coeff_filename = "a_input_10000.txt";
     char * free_terms_filename = "free_terms_10000.txt";
     char * unknown_no_filename = "unknown_no_10000.txt";
-    linear_system_of_equations lse = generate_system(number_of_equations);
-    write_system_of_equations(lse, coeff_filename, free_terms_filename, unknown_no_filename);
-    
+    const char * layout = "top_down";
+    linear_system_of_equations lse;
+    if(argc > 5){
+        number_of_equations = atoi(argv[1]);
+        coeff_filename = argv[3];
+        free_terms_filename = argv[4];
+        unknown_no_filename = argv[5];
+        if(argc > 6)layout = argv[6];
+        if(strcmp(layout, "top_down") != 0 && strcmp(layout, "bottom_up") != 0 && strcmp(layout, "binary") != 0){
+            printf("invalid layout %s (top_down, bottom_up or binary)\n", layout);
+            return 1;
+        }
+        lse = generate_seeded_system(number_of_equations, (unsigned int)strtoul(argv[2], NULL, 10));
+    }
+    else lse = generate_system(number_of_equations);
+
+    if(strcmp(layout, "top_down") == 0)write_system_of_equations(lse, coeff_filename, free_terms_filename, unknown_no_filename);
+    else{
+        write_number_of_unknowns(lse.unknowns_no, unknown_no_filename);
+        if(strcmp(layout, "binary") == 0)write_binary_coefficient_matrix(lse.coefficients, coeff_filename, lse.unknowns_no, BOTTOM_UP_ROWS);
+        else write_coefficient_matrix_in_order(lse.coefficients, coeff_filename, lse.unknowns_no, BOTTOM_UP_ROWS);
+        write_free_terms_array(lse.free_terms, free_terms_filename, lse.unknowns_no);
+    }
+
     return 0;
-}
\ No newline at end of file
+}
@@ -1,5 +1,22 @@
 #include "linear_system_schema.h"
 
+#ifndef SYSTEM_GENERATOR_H
+#define SYSTEM_GENERATOR_H
+
+enum row_order { TOP_DOWN_ROWS, BOTTOM_UP_ROWS };
+
 linear_system_of_equations generate_system(int n);
 
-void write_system_of_equations(linear_system_of_equations lse, char * coeff_filename, char * free_terms_filename);
+linear_system_of_equations generate_seeded_system(int n, unsigned int seed);
+
+linear_system_of_equations generate_general_system(int n);
+
+void write_system_of_equations(linear_system_of_equations lse, char * coeff_filename, char * free_terms_filename, char * unknown_no_filename);
+
+void write_general_coefficient_matrix(double ** coeff, char * coeff_filename, int number_of_unknowns);
+
+void write_coefficient_matrix_in_order(double ** coeff, char * coeff_filename, int number_of_unknowns, row_order order);
+
+void write_binary_coefficient_matrix(double ** coeff, char * coeff_filename, int number_of_unknowns, row_order order);
+
+#endif
@@ -7,7 +7,7 @@
  * @param coeff_filename 
  * @return int** 
  */
-double** read_coeff_matrix(char * coeff_filename){
+double** read_coeff_matrix(const char * coeff_filename){
     std::ifstream coeff_file(coeff_filename);
     // read the number of unknowns:
     int n;
@@ -27,7 +27,7 @@ double** read_coeff_matrix(char * coeff_filename){
     return result;
 }
 
-double * read_free_terms(char * free_term_filename, int number_of_equations){
+double * read_free_terms(const char * free_term_filename, int number_of_equations){
     std::ifstream free_tearm_file(free_term_filename);
     // read the number of equations:
     // read the values:
@@ -48,10 +48,41 @@ double * read_free_terms(char * free_term_filename, int number_of_equations){
  * @param no_unknowns 
  * @return linear_system_of_equations 
  */
-linear_system_of_equations read_linear_system(char * coeff_filename, char * free_terms_filename, int no_unknowns){
+linear_system_of_equations read_linear_system(const char * coeff_filename, const char * free_terms_filename, int no_unknowns){
     linear_system_of_equations result;
     result.coefficients = read_coeff_matrix(coeff_filename);
     result.free_terms = read_free_terms(free_terms_filename, no_unknowns);
     result.unknowns_no = no_unknowns;
     return result;
+}
+
+/**
+ * @brief Read a general (not triangular) system: every row of the coefficient file holds
+ * all the n coefficients of its equation.
+ *
+ * @param coeff_filename The name of the file that stores the coefficient matrix
+ * @param free_terms_filename The name of the file that stores the free terms
+ * @param unknown_no_filename The name of the file that stores the number of unknowns
+ * @return linear_system_of_equations The system
+ */
+linear_system_of_equations read_general_linear_system(const char * coeff_filename, const char * free_terms_filename, const char * unknown_no_filename){
+    linear_system_of_equations result;
+    std::ifstream unknowns_no_file(unknown_no_filename);
+    unknowns_no_file >> result.unknowns_no;
+    unknowns_no_file.close();
+
+    int n = result.unknowns_no;
+    std::ifstream coeff_file(coeff_filename);
+    result.coefficients = new double*[n];
+    for(int row_id = 0; row_id < n; row_id++){
+        result.coefficients[row_id] = new double[n];
+        for(int col_id = 0; col_id < n; col_id++)coeff_file >> result.coefficients[row_id][col_id];
+    }
+    coeff_file.close();
+
+    std::ifstream free_terms_file(free_terms_filename);
+    result.free_terms = new double[n];
+    for(int eq_id = 0; eq_id < n; eq_id++)free_terms_file >> result.free_terms[eq_id];
+    free_terms_file.close();
+    return result;
 }
\ No newline at end of file
@@ -3,6 +3,8 @@
 #ifndef SYSTEM_READER_H
 #define SYSTEM_READER_H
 
-linear_system_of_equations read_linear_system(char * coeff_filename, char * free_terms_filename, int no_unknowns);
+linear_system_of_equations read_linear_system(const char * coeff_filename, const char * free_terms_filename, int no_unknowns);
+
+linear_system_of_equations read_general_linear_system(const char * coeff_filename, const char * free_terms_filename, const char * unknown_no_filename);
 
 #endif
\ No newline at end of file
@@ -0,0 +1,80 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#include <chrono>
+#include <vector>
+
+#include "solver_library.h"
+#include "auto_tuner.h"
+#include "generated_pipeline.h"
+#include "throughput_scheduler.h"
+
+#define NUMBER_OF_SYSTEMS 200
+
+/**
+ * @brief Usage: throughput_benchmark [n] [systems] [mixed]
+ * Solves the same queue of systems one at a time with all the cores (as open_mp_assignment
+ * does), then concurrently with solve_concurrently; both runs use the back-end of
+ * configuration_for_system. With "mixed", the sizes cycle through n / 4, n / 2, n and 2n. The
+ * tuning table of run_auto_tuner is used when it exists.
+ */
+int main(int argc, char ** argv){
+    int n = (argc > 1) ? atoi(argv[1]) : 1000;
+    int systems_no = (argc > 2) ? atoi(argv[2]) : NUMBER_OF_SYSTEMS;
+    bool mixed = argc > 3 && strcmp(argv[3], "mixed") == 0;
+
+    std::vector<TriangularSystem *> owned_systems;
+    std::vector<const TriangularSystem *> systems;
+    for(int system_id = 0; system_id < systems_no; system_id++){
+        int size = n;
+        if(mixed)size = (system_id % 4 == 3) ? 2 * n : n / (4 >> (system_id % 4));
+        linear_system_of_equations lse = generate_stream_system(size, system_id + 1);
+        owned_systems.push_back(new TriangularSystem(lse));
+        systems.push_back(owned_systems.back());
+        for(int row_id = 0; row_id < size; row_id++)delete[] lse.coefficients[row_id];
+        delete[] lse.coefficients;
+        delete[] lse.free_terms;
+    }
+
+    std::vector<core_domain> domains = detect_core_domains();
+    int cores_no = 0;
+    for(size_t domain_id = 0; domain_id < domains.size(); domain_id++)cores_no += (int)domains[domain_id].cpus.size();
+    std::vector<tuning_entry> table = read_tuning_table(TUNING_FILENAME);
+    printf("%d systems, %d cores in %d domains, %s\n", systems_no, cores_no, (int)domains.size(), table.empty() ? "no tuning table" : "tuned");
+
+    /* One system at a time, with every core: */
+    std::vector<std::unique_ptr<Solver> > solvers;
+    for(int system_id = 0; system_id < systems_no; system_id++){
+        tuning_entry entry = configuration_for_system(systems[system_id]->unknowns_no(), table);
+        solvers.push_back(make_solver(entry.backend, cores_no, entry.block_size));
+    }
+    std::vector<std::vector<double> > reference(systems_no);
+    std::chrono::high_resolution_clock::time_point begin = std::chrono::high_resolution_clock::now();
+    for(int system_id = 0; system_id < systems_no; system_id++)reference[system_id] = solvers[system_id]->solve(*systems[system_id]);
+    std::chrono::high_resolution_clock::time_point end = std::chrono::high_resolution_clock::now();
+    double seconds = std::chrono::duration_cast<std::chrono::nanoseconds>(end - begin).count() * 1e-9;
+    printf("one at a time, %d threads: %f s, %.1f systems/s\n", cores_no, seconds, (seconds > 0) ? systems_no / seconds : 0.0);
+
+    std::vector<std::vector<double> > solutions;
+    scheduler_report report = solve_concurrently(systems, solutions, domains, table);
+    printf("concurrent: %f s, %.1f systems/s\n", report.seconds, report.systems_per_second);
+    for(size_t group_id = 0; group_id < report.groups.size(); group_id++){
+        const scheduler_group & group = report.groups[group_id];
+        printf("    %d systems on %d partitions of up to %d cores: %f s\n", group.systems_no, group.partitions_no, group.partition_size, group.seconds);
+    }
+
+    double largest_difference = 0.0;
+    for(int system_id = 0; system_id < systems_no; system_id++){
+        for(size_t sol_id = 0; sol_id < solutions[system_id].size(); sol_id++){
+            double expected = reference[system_id][sol_id];
+            double difference = fabs(solutions[system_id][sol_id] - expected) / (fabs(expected) > 0 ? fabs(expected) : 1.0);
+            if(difference > largest_difference)largest_difference = difference;
+        }
+    }
+    printf("largest relative difference to the one at a time solutions: %e\n", largest_difference);
+
+    for(int system_id = 0; system_id < systems_no; system_id++)delete owned_systems[system_id];
+    return 0;
+}
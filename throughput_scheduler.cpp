@@ -0,0 +1,229 @@
+#include "throughput_scheduler.h"
+#include <pthread.h>
+#include <sched.h>
+#include <stdio.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <fstream>
+#include <string>
+#include <thread>
+
+/**
+ * @brief The name of the domain of a cpu: the list of cpus that share its level 3 cache, else
+ * its socket, else one domain for the whole machine.
+ */
+std::string domain_key(int cpu){
+    char path[128];
+    for(int index = 0; index < 8; index++){
+        sprintf(path, "/sys/devices/system/cpu/cpu%d/cache/index%d/level", cpu, index);
+        std::ifstream level_file(path);
+        int level = 0;
+        if(!(level_file >> level))break;
+        if(level != 3)continue;
+        sprintf(path, "/sys/devices/system/cpu/cpu%d/cache/index%d/shared_cpu_list", cpu, index);
+        std::ifstream shared_file(path);
+        std::string shared_cpus;
+        if(shared_file >> shared_cpus)return "l3 " + shared_cpus;
+    }
+    sprintf(path, "/sys/devices/system/cpu/cpu%d/topology/physical_package_id", cpu);
+    std::ifstream package_file(path);
+    std::string package;
+    if(package_file >> package)return "socket " + package;
+    return "machine";
+}
+
+/**
+ * @brief Group the cpus the process may run on by last level cache (or socket).
+ *
+ * @return std::vector<core_domain> The domains, each with at least one cpu
+ */
+std::vector<core_domain> detect_core_domains(){
+    cpu_set_t allowed;
+    CPU_ZERO(&allowed);
+    if(sched_getaffinity(0, sizeof(allowed), &allowed) != 0){
+        for(unsigned int cpu = 0; cpu < std::thread::hardware_concurrency(); cpu++)CPU_SET(cpu, &allowed);
+    }
+    std::vector<std::string> keys;
+    std::vector<core_domain> domains;
+    for(int cpu = 0; cpu < CPU_SETSIZE; cpu++){
+        if(!CPU_ISSET(cpu, &allowed))continue;
+        std::string key = domain_key(cpu);
+        size_t domain_id = std::find(keys.begin(), keys.end(), key) - keys.begin();
+        if(domain_id == keys.size()){
+            keys.push_back(key);
+            domains.push_back(core_domain());
+        }
+        domains[domain_id].cpus.push_back(cpu);
+    }
+    return domains;
+}
+
+/**
+ * @brief The configuration of a solve in a throughput run: the entry of the tuning table with the
+ * fewest seconds x threads for its size (THROUGHPUT_GOAL), else the OpenMP back-end with one core
+ * per SCHEDULER_ROWS_PER_THREAD rows. throughput_benchmark solves with its back-end in both of
+ * its runs, so that they only differ in how the cores are shared.
+ */
+tuning_entry configuration_for_system(int unknowns_no, const std::vector<tuning_entry> & table){
+    if(!table.empty())return choose_tuning_entry(table, unknowns_no, 1, THROUGHPUT_GOAL);
+    tuning_entry result;
+    result.unknowns_no = unknowns_no;
+    result.rhs_no = 1;
+    result.backend = OPEN_MP_BACKEND;
+    result.number_of_threads = (unknowns_no + SCHEDULER_ROWS_PER_THREAD - 1) / SCHEDULER_ROWS_PER_THREAD;
+    result.block_size = 0;
+    result.seconds = 0.0;
+    result.goal = THROUGHPUT_GOAL;
+    return result;
+}
+
+/**
+ * @brief The number of cores of the solve of a system (see configuration_for_system), never more
+ * than a domain.
+ */
+int threads_for_system(int unknowns_no, const std::vector<tuning_entry> & table, int domain_size){
+    int threads_no = configuration_for_system(unknowns_no, table).number_of_threads;
+    if(threads_no < 1)threads_no = 1;
+    if(threads_no > domain_size)threads_no = domain_size;
+    return threads_no;
+}
+
+/**
+ * @brief The queue of a group, shared by its partition workers: the systems of the group, largest
+ * first, and the position of the next one to solve.
+ */
+struct scheduler_queue {
+    const std::vector<const TriangularSystem *> *systems;
+    std::vector<std::vector<double> > *solutions;
+    const std::vector<tuning_entry> *table;
+    std::vector<int> order;
+    std::atomic<int> next_position;
+};
+
+/**
+ * @brief A partition worker: pinned to its cores for the whole group (so its OpenMP team is
+ * created once, on those cores, and reused), it takes the next system of the queue until the
+ * queue is empty, and solves it with one thread per core of the partition.
+ */
+void partition_worker(scheduler_queue * queue, std::vector<int> cpus){
+    cpu_set_t cpu_set;
+    CPU_ZERO(&cpu_set);
+    for(size_t i = 0; i < cpus.size(); i++)CPU_SET(cpus[i], &cpu_set);
+    /* The OpenMP threads of the solves inherit the mask: */
+    pthread_setaffinity_np(pthread_self(), sizeof(cpu_set), &cpu_set);
+
+    int threads_no = (int)cpus.size();
+    std::unique_ptr<Solver> solver;
+    solver_backend solver_of_backend = SEQUENTIAL_BACKEND;
+    int solver_block_size = 0;
+    while(true){
+        int position = queue->next_position.fetch_add(1);
+        if(position >= (int)queue->order.size())break;
+        int system_id = queue->order[position];
+        const TriangularSystem * system = (*queue->systems)[system_id];
+        tuning_entry entry = configuration_for_system(system->unknowns_no(), *queue->table);
+        if(!solver || entry.backend != solver_of_backend || entry.block_size != solver_block_size){
+            solver = make_solver(entry.backend, threads_no, entry.block_size);
+            solver_of_backend = entry.backend;
+            solver_block_size = entry.block_size;
+        }
+        (*queue->solutions)[system_id] = solver->solve(*system);
+    }
+}
+
+/**
+ * @brief Solve the systems of one group: every domain is cut into partitions of partition_size
+ * cores (the last one of a domain takes the cores that are left), and every partition gets one
+ * worker pinned to it, until the queue of the group is empty.
+ */
+scheduler_group solve_group_concurrently(scheduler_queue & queue, const std::vector<core_domain> & domains, int partition_size){
+    std::vector<std::vector<int> > partitions;
+    for(size_t domain_id = 0; domain_id < domains.size(); domain_id++){
+        const std::vector<int> & cpus = domains[domain_id].cpus;
+        for(size_t first = 0; first < cpus.size(); first += partition_size){
+            size_t last = std::min(first + partition_size, cpus.size());
+            partitions.push_back(std::vector<int>(cpus.begin() + first, cpus.begin() + last));
+        }
+    }
+    /* More workers than systems would only create idle teams: */
+    if(partitions.size() > queue.order.size())partitions.resize(queue.order.size());
+
+    scheduler_group group;
+    group.partition_size = partition_size;
+    group.partitions_no = (int)partitions.size();
+    group.systems_no = (int)queue.order.size();
+    std::chrono::high_resolution_clock::time_point begin = std::chrono::high_resolution_clock::now();
+    std::vector<std::thread> workers;
+    for(size_t partition_id = 0; partition_id < partitions.size(); partition_id++)
+        workers.push_back(std::thread(partition_worker, &queue, partitions[partition_id]));
+    for(size_t partition_id = 0; partition_id < workers.size(); partition_id++)workers[partition_id].join();
+    std::chrono::high_resolution_clock::time_point end = std::chrono::high_resolution_clock::now();
+    group.seconds = std::chrono::duration_cast<std::chrono::nanoseconds>(end - begin).count() * 1e-9;
+    return group;
+}
+
+/**
+ * @brief Solve many systems at once, to maximize the systems per second rather than the latency
+ * of one solve. The systems are grouped by the number of cores they were sized for
+ * (threads_for_system), and the groups run one after the other, widest first: for each group,
+ * the domains are cut into partitions of that many cores, each with one persistent worker pinned
+ * to it, and the workers take the systems of the group from one queue, largest first.
+ * So every system is solved on the cores it was tuned for; the cost is one join per group, where
+ * the partitions that finish early wait for the last system of the group.
+ *
+ * @param systems The systems; they must stay alive until the function returns
+ * @param solutions Receives the solution of every system, in the same order
+ * @param domains The core domains to use (see detect_core_domains)
+ * @param table A tuning table for the back-end and threads of every size, or an empty table
+ * @return scheduler_report The throughput of the run, and its groups in the order they ran
+ */
+scheduler_report solve_concurrently(const std::vector<const TriangularSystem *> & systems, std::vector<std::vector<double> > & solutions,
+                                    const std::vector<core_domain> & domains, const std::vector<tuning_entry> & table){
+    int systems_no = (int)systems.size();
+    solutions.assign(systems_no, std::vector<double>());
+
+    int cores_no = 0;
+    int largest_domain = 0;
+    for(size_t domain_id = 0; domain_id < domains.size(); domain_id++){
+        cores_no += (int)domains[domain_id].cpus.size();
+        largest_domain = std::max(largest_domain, (int)domains[domain_id].cpus.size());
+    }
+
+    /* Widest group first, and the largest systems first inside a group: */
+    std::vector<int> widths(systems_no);
+    std::vector<int> order(systems_no);
+    for(int system_id = 0; system_id < systems_no; system_id++){
+        widths[system_id] = threads_for_system(systems[system_id]->unknowns_no(), table, largest_domain);
+        order[system_id] = system_id;
+    }
+    std::stable_sort(order.begin(), order.end(), [&systems, &widths](int a, int b) {
+        if(widths[a] != widths[b])return widths[a] > widths[b];
+        return systems[a]->unknowns_no() > systems[b]->unknowns_no();
+    });
+
+    scheduler_report report;
+    report.systems_no = systems_no;
+    report.domains_no = (int)domains.size();
+    report.cores_no = cores_no;
+    std::chrono::high_resolution_clock::time_point begin = std::chrono::high_resolution_clock::now();
+
+    for(size_t first = 0; first < order.size();){
+        size_t last = first;
+        while(last < order.size() && widths[order[last]] == widths[order[first]])last++;
+        scheduler_queue queue;
+        queue.systems = &systems;
+        queue.solutions = &solutions;
+        queue.table = &table;
+        queue.order.assign(order.begin() + first, order.begin() + last);
+        queue.next_position.store(0);
+        report.groups.push_back(solve_group_concurrently(queue, domains, widths[order[first]]));
+        first = last;
+    }
+
+    std::chrono::high_resolution_clock::time_point end = std::chrono::high_resolution_clock::now();
+    report.seconds = std::chrono::duration_cast<std::chrono::nanoseconds>(end - begin).count() * 1e-9;
+    report.systems_per_second = (report.seconds > 0) ? systems_no / report.seconds : 0.0;
+    return report;
+}
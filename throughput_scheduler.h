@@ -0,0 +1,51 @@
+#include "solver_library.h"
+
+#ifndef THROUGHPUT_SCHEDULER_H
+#define THROUGHPUT_SCHEDULER_H
+
+#include <vector>
+
+/* Without a tuning table, a system of n unknowns gets one core per this many rows: */
+#define SCHEDULER_ROWS_PER_THREAD 512
+
+/**
+ * @brief The cores that share a last level cache (or, if the cache is not described, a socket).
+ * A solve never spans two domains.
+ */
+struct core_domain {
+    std::vector<int> cpus;
+};
+
+/**
+ * @brief The systems of a run that were sized for the same number of cores (see
+ * threads_for_system), and the partitions they were solved on.
+ */
+struct scheduler_group {
+    int partition_size;
+    int partitions_no;
+    int systems_no;
+    double seconds;
+};
+
+/**
+ * @brief The throughput of a run; systems_per_second is 0 if the run took no measurable time.
+ */
+struct scheduler_report {
+    int systems_no;
+    int domains_no;
+    int cores_no;
+    std::vector<scheduler_group> groups;
+    double seconds;
+    double systems_per_second;
+};
+
+std::vector<core_domain> detect_core_domains();
+
+tuning_entry configuration_for_system(int unknowns_no, const std::vector<tuning_entry> & table);
+
+int threads_for_system(int unknowns_no, const std::vector<tuning_entry> & table, int domain_size);
+
+scheduler_report solve_concurrently(const std::vector<const TriangularSystem *> & systems, std::vector<std::vector<double> > & solutions,
+                                    const std::vector<core_domain> & domains, const std::vector<tuning_entry> & table);
+
+#endif
@@ -0,0 +1,32 @@
+#include "triangular_solver.h"
+
+/**
+ * @brief Solve op(A) * x = b for the system, choosing the variant of triangular_solve at run time.
+ *
+ * @param lse The linear system of equations; only the chosen triangle of its coefficients is read
+ * @param part Which triangle of the coefficient matrix is used
+ * @param operation Whether the triangle or its transpose is solved
+ * @param diagonal Whether the diagonal is read or assumed to be 1
+ * @param number_of_threads The number of OpenMP threads
+ * @return double* The solution of the system
+ */
+double * triangular_system_solver(linear_system_of_equations lse, triangle_part part, triangle_operation operation, triangle_diagonal diagonal, int number_of_threads){
+    int n = lse.unknowns_no;
+    double * x = new double[n];
+    for(int i = 0; i < n; i++)x[i] = lse.free_terms[i];
+
+    typedef void (*triangular_kernel)(double **, double *, int, int);
+    /* kernels[part][operation][diagonal]: */
+    triangular_kernel kernels[2][2][2] = {
+        {
+            {&triangular_solve<UPPER_TRIANGLE, NO_TRANSPOSE, NON_UNIT_DIAGONAL>, &triangular_solve<UPPER_TRIANGLE, NO_TRANSPOSE, UNIT_DIAGONAL>},
+            {&triangular_solve<UPPER_TRIANGLE, TRANSPOSE, NON_UNIT_DIAGONAL>, &triangular_solve<UPPER_TRIANGLE, TRANSPOSE, UNIT_DIAGONAL>}
+        },
+        {
+            {&triangular_solve<LOWER_TRIANGLE, NO_TRANSPOSE, NON_UNIT_DIAGONAL>, &triangular_solve<LOWER_TRIANGLE, NO_TRANSPOSE, UNIT_DIAGONAL>},
+            {&triangular_solve<LOWER_TRIANGLE, TRANSPOSE, NON_UNIT_DIAGONAL>, &triangular_solve<LOWER_TRIANGLE, TRANSPOSE, UNIT_DIAGONAL>}
+        }
+    };
+    kernels[part][operation][diagonal](lse.coefficients, x, n, number_of_threads);
+    return x;
+}
@@ -0,0 +1,92 @@
+#include "linear_system_schema.h"
+
+#ifndef TRIANGULAR_SOLVER_H
+#define TRIANGULAR_SOLVER_H
+
+/* The size of the diagonal blocks of the blocked kernel: */
+#define TRIANGULAR_BLOCK_SIZE 128
+/* The rectangle updates are only split between threads above this number of unknowns: */
+#define TRIANGULAR_PARALLEL_THRESHOLD 1024
+
+enum triangle_part { UPPER_TRIANGLE, LOWER_TRIANGLE };
+enum triangle_operation { NO_TRANSPOSE, TRANSPOSE };
+enum triangle_diagonal { NON_UNIT_DIAGONAL, UNIT_DIAGONAL };
+
+/**
+ * @brief Solve op(A) * x = b, where A is the PART triangle of a (the other triangle is never read),
+ * op(A) is A or its transpose, and the diagonal is either read or assumed to be 1.
+ * All the eight variants share this blocked kernel; the orientation only decides, at compile time,
+ * in which direction the blocks are visited and whether the rows of a are used as dot products
+ * (NO_TRANSPOSE) or as axpy updates (TRANSPOSE), so the memory is always read contiguously.
+ *
+ * @param a The rows of the matrix
+ * @param x The free terms on input, the solution on output
+ * @param n The number of unknowns
+ * @param number_of_threads The number of OpenMP threads used by the rectangle updates
+ */
+template<triangle_part PART, triangle_operation OPERATION, triangle_diagonal DIAGONAL>
+void triangular_solve(double ** a, double * x, int n, int number_of_threads){
+    /* op(A) is lower triangular (solved first to last) or upper triangular (solved last to first): */
+    const bool forward = (PART == LOWER_TRIANGLE) != (OPERATION == TRANSPOSE);
+    int blocks_no = (n + TRIANGULAR_BLOCK_SIZE - 1) / TRIANGULAR_BLOCK_SIZE;
+
+    for(int step = 0; step < blocks_no; step++){
+        int block_id = forward ? step : blocks_no - 1 - step;
+        int first = block_id * TRIANGULAR_BLOCK_SIZE;
+        int last = (first + TRIANGULAR_BLOCK_SIZE < n) ? first + TRIANGULAR_BLOCK_SIZE : n;
+
+        /* The diagonal block: */
+        for(int k = 0; k < last - first; k++){
+            int i = forward ? first + k : last - 1 - k;
+            if(OPERATION == NO_TRANSPOSE){
+                double * row = a[i];
+                int begin = forward ? first : i + 1;
+                int end = forward ? i : last;
+                double sum = x[i];
+                #pragma omp simd reduction(-:sum)
+                for(int j = begin; j < end; j++)sum -= row[j] * x[j];
+                x[i] = sum;
+            }
+            if(DIAGONAL == NON_UNIT_DIAGONAL){
+                if(a[i][i] != 0)x[i] /= a[i][i];
+                else x[i] = 0;
+            }
+            if(OPERATION == TRANSPOSE){
+                double * row = a[i];
+                double value = x[i];
+                int begin = forward ? i + 1 : first;
+                int end = forward ? last : i;
+                #pragma omp simd
+                for(int j = begin; j < end; j++)x[j] -= row[j] * value;
+            }
+        }
+
+        /* The rectangle between the block and the unknowns that are not solved yet: */
+        int remaining_begin = forward ? last : 0;
+        int remaining_end = forward ? n : first;
+        int remaining = remaining_end - remaining_begin;
+        if(OPERATION == NO_TRANSPOSE){
+            #pragma omp parallel for schedule(static) num_threads(number_of_threads) if(remaining > TRIANGULAR_PARALLEL_THRESHOLD)
+            for(int i = remaining_begin; i < remaining_end; i++){
+                double * row = a[i];
+                double sum = 0.0;
+                #pragma omp simd reduction(+:sum)
+                for(int j = first; j < last; j++)sum += row[j] * x[j];
+                x[i] -= sum;
+            }
+        }
+        else{
+            #pragma omp parallel num_threads(number_of_threads) if(remaining > TRIANGULAR_PARALLEL_THRESHOLD)
+            for(int j = first; j < last; j++){
+                double * row = a[j];
+                double value = x[j];
+                #pragma omp for simd schedule(static) nowait
+                for(int i = remaining_begin; i < remaining_end; i++)x[i] -= row[i] * value;
+            }
+        }
+    }
+}
+
+double * triangular_system_solver(linear_system_of_equations lse, triangle_part part, triangle_operation operation, triangle_diagonal diagonal, int number_of_threads);
+
+#endif